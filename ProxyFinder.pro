@@ -13,24 +13,69 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 HEADERS += \
+    backend/IpAddress/ipaddress.h \
+    backend/AddressSet/addressset.h \
+    backend/PortSet/portset.h \
+    backend/TargetGenerator/targetgenerator.h \
     backend/ProxyChecker/proxychecker.h \
-    backend/ProxyCheckerThreadWrapper/proxycheckerthreadwrapper.h \
-    backend/ProxyInfo/proxyinfo.h \
+    backend/ProbeEngine/probeengine.h \
+    backend/ProxyCheckerPool/proxycheckerpool.h \
+    backend/ConcurrencyController/concurrencycontroller.h \
+    backend/RateLimiter/ratelimiter.h \
+    backend/RttEstimator/rttestimator.h \
+    backend/TimerWheel/timerwheel.h \
+    backend/LatencyHistogram/latencyhistogram.h \
+    backend/ScanStatistics/scanstatistics.h \
+    backend/HostCache/hostcache.h \
+    backend/Revalidator/revalidator.h \
+    backend/ProtocolDetector/protocoldetector.h \
+    backend/ProxyBenchmark/proxybenchmark.h \
     backend/ThreadedFinder/threadedfinder.h \
     backend/ApplicationManager/applicationmanager.h \
+    backend/CommandLineScanner/commandlinescanner.h \
+    backend/ResultSink/resultsink.h \
+    backend/ResultWriter/resultwriter.h \
+    backend/ScanCheckpoint/scancheckpoint.h \
+    backend/ScanResult/scanresult.h \
+    backend/ResultStore/resultstore.h \
     backend/Settings/settings.h \
     backend/models/ReportModel/reportmodel.h
 
 SOURCES += \
         main.cpp \
+    backend/IpAddress/ipaddress.cpp \
+    backend/AddressSet/addressset.cpp \
+    backend/PortSet/portset.cpp \
+    backend/TargetGenerator/targetgenerator.cpp \
     backend/ProxyChecker/proxychecker.cpp \
-    backend/ProxyCheckerThreadWrapper/proxycheckerthreadwrapper.cpp \
-    backend/ProxyInfo/proxyinfo.cpp \
+    backend/ProbeEngine/probeengine.cpp \
+    backend/ProxyCheckerPool/proxycheckerpool.cpp \
+    backend/ConcurrencyController/concurrencycontroller.cpp \
+    backend/RateLimiter/ratelimiter.cpp \
+    backend/RttEstimator/rttestimator.cpp \
+    backend/TimerWheel/timerwheel.cpp \
+    backend/LatencyHistogram/latencyhistogram.cpp \
+    backend/ScanStatistics/scanstatistics.cpp \
+    backend/HostCache/hostcache.cpp \
+    backend/Revalidator/revalidator.cpp \
+    backend/ProtocolDetector/protocoldetector.cpp \
+    backend/ProxyBenchmark/proxybenchmark.cpp \
     backend/ThreadedFinder/threadedfinder.cpp \
     backend/ApplicationManager/applicationmanager.cpp \
+    backend/CommandLineScanner/commandlinescanner.cpp \
+    backend/ResultSink/resultsink.cpp \
+    backend/ResultWriter/resultwriter.cpp \
+    backend/ScanCheckpoint/scancheckpoint.cpp \
+    backend/ResultStore/resultstore.cpp \
     backend/Settings/settings.cpp \
     backend/models/ReportModel/reportmodel.cpp
 
+# The native probe engine is built on epoll
+linux {
+    HEADERS += backend/EpollProbeEngine/epollprobeengine.h
+    SOURCES += backend/EpollProbeEngine/epollprobeengine.cpp
+}
+
 RESOURCES += ui/qml.qrc \
     resources/qt.qrc \
     resources/images/images.qrc
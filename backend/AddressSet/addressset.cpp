@@ -0,0 +1,514 @@
+#include "addressset.h"
+#include <QFile>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+// Patterns may not cover more than 2^32 subnets
+static const int MinimumPatternPrefix = 32;
+
+static quint64 saturatedAdd(quint64 a, quint64 b)
+{
+    return a > std::numeric_limits<quint64>::max() - b ? std::numeric_limits<quint64>::max() : a + b;
+}
+
+static quint64 saturatedMultiply(quint64 a, quint64 b)
+{
+    return b != 0 && a > std::numeric_limits<quint64>::max() / b ? std::numeric_limits<quint64>::max() : a * b;
+}
+
+bool AddressSet::Pattern::operator<(const Pattern &other) const
+{
+    if (network != other.network) {
+        return network < other.network;
+    }
+    if (subnets != other.subnets) {
+        return subnets < other.subnets;
+    }
+    if (firstSuffix != other.firstSuffix) {
+        return firstSuffix < other.firstSuffix;
+    }
+    return lastSuffix < other.lastSuffix;
+}
+
+typedef QPair<quint64, quint64> SuffixRange;
+
+static void subtractSuffixes(QVector<SuffixRange> &ranges, quint64 first, quint64 last)
+{
+    QVector<SuffixRange> kept;
+    for (const SuffixRange &range : ranges) {
+        if (range.second < first || range.first > last) {
+            kept.append(range);
+            continue;
+        }
+        if (range.first < first) {
+            kept.append(qMakePair(range.first, first - 1));
+        }
+        if (range.second > last) {
+            kept.append(qMakePair(last + 1, range.second));
+        }
+    }
+    ranges.swap(kept);
+}
+
+// The first interval ending in the subnet or after it
+static QVector<QPair<IpAddress, IpAddress>>::const_iterator firstIntervalFrom(const QVector<QPair<IpAddress, IpAddress>> &intervals, quint64 subnet)
+{
+    return std::lower_bound(intervals.constBegin(), intervals.constEnd(), subnet,
+                            [](const QPair<IpAddress, IpAddress> &interval, quint64 value) {
+        return interval.second.high() < value;
+    });
+}
+
+AddressSet::AddressSet()
+{
+}
+
+void AddressSet::insert(const IpAddress &first, const IpAddress &last)
+{
+    if (first == last) {
+        addresses.append(first);
+    } else if (first < last) {
+        intervals.append(qMakePair(first, last));
+    }
+}
+
+bool AddressSet::insert(const QByteArray &entry)
+{
+    const QByteArray text = entry.trimmed();
+    if (text.isEmpty()) {
+        return true;
+    }
+    const char *begin = text.constData();
+    const char *end = begin + text.size();
+
+    // Prefix and suffix pattern
+    const int at = text.indexOf('@');
+    if (at >= 0) {
+        return insertPattern(text.left(at), text.mid(at + 1));
+    }
+
+    // CIDR block, IPv4 prefixes are relative to the mapped address
+    const int slash = text.indexOf('/');
+    if (slash >= 0) {
+        IpAddress address;
+        bool ok = false;
+        int prefix = text.mid(slash + 1).toInt(&ok);
+        if (!ok || !IpAddress::parse(begin, begin + slash, &address)) {
+            return false;
+        }
+        if (address.isIPv4() && text.left(slash).indexOf(':') < 0) {
+            prefix += 96;
+        }
+        if (prefix < (address.isIPv4() ? 96 : 0) || prefix > 128) {
+            return false;
+        }
+        insert(address.firstInPrefix(prefix), address.lastInPrefix(prefix));
+        return true;
+    }
+
+    // Dash range, the last address may be given by its last octet or hextet only
+    const int dash = text.indexOf('-');
+    if (dash >= 0) {
+        IpAddress first, last;
+        if (!IpAddress::parse(begin, begin + dash, &first)) {
+            return false;
+        }
+        if (!IpAddress::parse(begin + dash + 1, end, &last)) {
+            bool ok = false;
+            const QByteArray tail = text.mid(dash + 1).trimmed();
+            if (first.isIPv4()) {
+                const uint octet = tail.toUInt(&ok);
+                if (!ok || octet > 0xFF) {
+                    return false;
+                }
+                last = IpAddress(first.high(), (first.low() & ~quint64(0xFF)) | octet);
+            } else {
+                const uint hextet = tail.toUInt(&ok, 16);
+                if (!ok || hextet > 0xFFFF) {
+                    return false;
+                }
+                last = IpAddress(first.high(), (first.low() & ~quint64(0xFFFF)) | hextet);
+            }
+        }
+        if (last < first) {
+            return false;
+        }
+        insert(first, last);
+        return true;
+    }
+
+    IpAddress address;
+    if (!IpAddress::parse(begin, end, &address)) {
+        return false;
+    }
+    insert(address, address);
+    return true;
+}
+
+bool AddressSet::insertPattern(const QByteArray &prefix, const QByteArray &suffixes)
+{
+    const int slash = prefix.indexOf('/');
+    IpAddress network;
+    bool ok = false;
+    const int prefixLength = prefix.mid(slash + 1).toInt(&ok);
+    if (slash < 0 || !ok || prefixLength < MinimumPatternPrefix || prefixLength > 64
+            || !IpAddress::parse(prefix.constData(), prefix.constData() + slash, &network) || network.isIPv4()) {
+        return false;
+    }
+
+    // Suffixes are interface identifiers, as in ::1 or ::1-::ff
+    const int dash = suffixes.indexOf('-');
+    IpAddress first, last;
+    const char *begin = suffixes.constData();
+    const char *end = begin + suffixes.size();
+    if (!IpAddress::parse(begin, dash < 0 ? end : begin + dash, &first) || first.high() != 0) {
+        return false;
+    }
+    last = first;
+    if (dash >= 0 && (!IpAddress::parse(begin + dash + 1, end, &last) || last.high() != 0 || last.low() < first.low())) {
+        return false;
+    }
+
+    const Pattern entry = { network.firstInPrefix(prefixLength).high(), quint64(1) << (64 - prefixLength),
+                            first.low(), last.low() };
+    patterns.append(entry);
+    return true;
+}
+
+int AddressSet::insertList(const QByteArray &list)
+{
+    // Entries are separated by commas, semicolons or blanks, and '#' starts a comment
+    int invalidEntries = 0;
+    int start = 0;
+    bool comment = false;
+    for (int i = 0; i <= list.size(); ++i) {
+        const char c = i < list.size() ? list[i] : '\n';
+        if (c == '\n' || c == '\r' || ((c == ',' || c == ';' || c == ' ' || c == '\t' || c == '#') && !comment)) {
+            if (!comment && i > start && !insert(list.mid(start, i - start))) {
+                invalidEntries++;
+            }
+            if (c == '#') {
+                comment = true;
+            } else if (c == '\n' || c == '\r') {
+                comment = false;
+            }
+            start = i + 1;
+        }
+    }
+    return invalidEntries;
+}
+
+bool AddressSet::insertFile(const QString &fileName, int *invalidEntries)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    int invalid = 0;
+    while (!file.atEnd()) {
+        invalid += insertList(file.readLine());
+    }
+    if (invalidEntries) {
+        *invalidEntries = invalid;
+    }
+    return true;
+}
+
+void AddressSet::normalize()
+{
+    std::sort(intervals.begin(), intervals.end());
+
+    // Merge overlapping and adjacent intervals
+    int merged = 0;
+    for (int i = 1; i < intervals.count(); ++i) {
+        QPair<IpAddress, IpAddress> &current = intervals[merged];
+        const bool touching = current.second == IpAddress(~quint64(0), ~quint64(0))
+                || intervals[i].first <= current.second.next();
+        if (touching) {
+            current.second = qMax(current.second, intervals[i].second);
+        } else {
+            intervals[++merged] = intervals[i];
+        }
+    }
+    if (!intervals.isEmpty()) {
+        intervals.resize(merged + 1);
+    }
+
+    // Intervals of a single address join the single addresses
+    QVector<IpAddress> singles;
+    int ranges = 0;
+    for (const auto &range : intervals) {
+        if (range.first == range.second) {
+            singles.append(range.first);
+        } else {
+            intervals[ranges++] = range;
+        }
+    }
+    intervals.resize(ranges);
+    intervals.squeeze();
+
+    std::sort(addresses.begin(), addresses.end());
+    QVector<IpAddress> sorted;
+    sorted.reserve(addresses.count() + singles.count());
+    std::merge(addresses.constBegin(), addresses.constEnd(), singles.constBegin(), singles.constEnd(), std::back_inserter(sorted));
+    addresses.swap(sorted);
+    sorted = QVector<IpAddress>();
+
+    normalizePatterns();
+
+    // Drop the repeated addresses and the ones already covered by a range or a pattern
+    int kept = 0;
+    int range = 0;
+    for (int i = 0; i < addresses.count(); ++i) {
+        const IpAddress &current = addresses[i];
+        while (range < intervals.count() && intervals[range].second < current) {
+            range++;
+        }
+        const bool covered = range < intervals.count() && intervals[range].first <= current;
+        if (!covered && (kept == 0 || addresses[kept - 1] != current) && !patternsContain(current)) {
+            addresses[kept++] = current;
+        }
+    }
+    addresses.resize(kept);
+    addresses.squeeze();
+
+    total = quint64(addresses.count());
+    for (const auto &range : intervals) {
+        total = saturatedAdd(total, range.first.count(range.second));
+    }
+    for (const auto &entry : patterns) {
+        const quint64 suffixes = IpAddress(0, entry.firstSuffix).count(IpAddress(0, entry.lastSuffix));
+        total = saturatedAdd(total, saturatedMultiply(entry.subnets, suffixes));
+    }
+    rewind();
+}
+
+void AddressSet::normalizePatterns()
+{
+    if (patterns.isEmpty()) {
+        return;
+    }
+    const quint64 Max = std::numeric_limits<quint64>::max();
+
+    // The subnets are cut into slabs, each covered whole or not at all by
+    // every pattern, and by every interval except the ones starting or ending
+    // in it, which make slabs of their own subnet
+    quint64 hullFirst = Max, hullLast = 0;
+    QVector<quint64> cuts;
+    for (const Pattern &entry : patterns) {
+        const quint64 last = entry.network + (entry.subnets - 1);
+        hullFirst = qMin(hullFirst, entry.network);
+        hullLast = qMax(hullLast, last);
+        cuts << entry.network;
+        if (last != Max) {
+            cuts << last + 1;
+        }
+    }
+    for (auto it = firstIntervalFrom(intervals, hullFirst); it != intervals.constEnd() && it->first.high() <= hullLast; ++it) {
+        for (const quint64 subnet : { it->first.high(), it->second.high() }) {
+            cuts << subnet;
+            if (subnet != Max) {
+                cuts << subnet + 1;
+            }
+        }
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    QVector<Pattern> disjoint;
+    QVector<Pattern> open; // rectangles reaching the previous slab, which may grow into this one
+    for (int i = 0; i < cuts.count(); ++i) {
+        const quint64 first = cuts[i];
+        if (first < hullFirst || first > hullLast) {
+            continue;
+        }
+        const quint64 last = i + 1 < cuts.count() ? qMin(cuts[i + 1] - 1, hullLast) : hullLast;
+
+        // Union of the suffixes of the patterns over the slab...
+        QVector<SuffixRange> suffixes;
+        for (const Pattern &entry : patterns) {
+            if (entry.network <= first && last <= entry.network + (entry.subnets - 1)) {
+                suffixes.append(qMakePair(entry.firstSuffix, entry.lastSuffix));
+            }
+        }
+        std::sort(suffixes.begin(), suffixes.end());
+        int merged = 0;
+        for (int j = 1; j < suffixes.count(); ++j) {
+            SuffixRange &current = suffixes[merged];
+            if (current.second == Max || suffixes[j].first <= current.second + 1) {
+                current.second = qMax(current.second, suffixes[j].second);
+            } else {
+                suffixes[++merged] = suffixes[j];
+            }
+        }
+        if (!suffixes.isEmpty()) {
+            suffixes.resize(merged + 1);
+        }
+
+        // ...without what the intervals cover
+        for (auto it = firstIntervalFrom(intervals, first); it != intervals.constEnd() && it->first.high() <= last && !suffixes.isEmpty(); ++it) {
+            subtractSuffixes(suffixes, it->first.high() >= first ? it->first.low() : 0,
+                             it->second.high() <= last ? it->second.low() : Max);
+        }
+
+        // Rectangles with the same suffixes in the previous slab grow, the others start here
+        QVector<Pattern> current;
+        for (const SuffixRange &range : suffixes) {
+            Pattern entry = { first, last - first + 1, range.first, range.second };
+            for (Pattern &previous : open) {
+                if (previous.subnets > 0 && previous.firstSuffix == range.first && previous.lastSuffix == range.second
+                        && previous.network + previous.subnets == first) {
+                    entry.network = previous.network;
+                    entry.subnets += previous.subnets;
+                    previous.subnets = 0;
+                    break;
+                }
+            }
+            current.append(entry);
+        }
+        for (const Pattern &previous : open) {
+            if (previous.subnets > 0) {
+                disjoint.append(previous);
+            }
+        }
+        open.swap(current);
+    }
+    disjoint += open;
+
+    std::sort(disjoint.begin(), disjoint.end());
+    patterns.swap(disjoint);
+    patterns.squeeze();
+}
+
+bool AddressSet::patternsContain(const IpAddress &address) const
+{
+    for (const Pattern &p : patterns) {
+        if (address.high() - p.network < p.subnets && address.low() >= p.firstSuffix && address.low() <= p.lastSuffix) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AddressSet::isEmpty() const
+{
+    return intervals.isEmpty() && addresses.isEmpty() && patterns.isEmpty();
+}
+
+bool AddressSet::contains(const IpAddress &address) const
+{
+    // The first interval ending at or after the address
+    const auto range = std::lower_bound(intervals.constBegin(), intervals.constEnd(), address,
+                                        [](const QPair<IpAddress, IpAddress> &interval, const IpAddress &value) {
+        return interval.second < value;
+    });
+    if (range != intervals.constEnd() && range->first <= address) {
+        return true;
+    }
+    if (std::binary_search(addresses.constBegin(), addresses.constEnd(), address)) {
+        return true;
+    }
+    return patternsContain(address);
+}
+
+quint64 AddressSet::size() const
+{
+    return total;
+}
+
+void AddressSet::rewind()
+{
+    interval = 0;
+    cursor = intervals.isEmpty() ? IpAddress() : intervals.first().first;
+    address = 0;
+    pattern = 0;
+    subnet = 0;
+    suffix = patterns.isEmpty() ? 0 : patterns.first().firstSuffix;
+    consumed = 0;
+}
+
+void AddressSet::seek(quint64 position)
+{
+    // Whole intervals and patterns are skipped by their size
+    rewind();
+    consumed = qMin(position, total);
+    while (interval < intervals.count()) {
+        const quint64 size = intervals[interval].first.count(intervals[interval].second);
+        if (position < size) {
+            cursor = intervals[interval].first.advanced(position);
+            return;
+        }
+        position -= size;
+        if (++interval < intervals.count()) {
+            cursor = intervals[interval].first;
+        }
+    }
+
+    if (position < quint64(addresses.count())) {
+        address = int(position);
+        return;
+    }
+    position -= quint64(addresses.count());
+    address = addresses.count();
+
+    while (pattern < patterns.count()) {
+        const Pattern &current = patterns[pattern];
+        const quint64 suffixes = IpAddress(0, current.firstSuffix).count(IpAddress(0, current.lastSuffix));
+        const quint64 size = saturatedMultiply(current.subnets, suffixes);
+        if (position < size) {
+            subnet = position / suffixes;
+            suffix = current.firstSuffix + position % suffixes;
+            return;
+        }
+        position -= size;
+        if (++pattern < patterns.count()) {
+            suffix = patterns[pattern].firstSuffix;
+        }
+    }
+}
+
+bool AddressSet::hasNext() const
+{
+    return interval < intervals.count() || address < addresses.count() || pattern < patterns.count();
+}
+
+IpAddress AddressSet::next()
+{
+    consumed++;
+    if (interval < intervals.count()) {
+        const IpAddress current = cursor;
+        if (current == intervals[interval].second) {
+            if (++interval < intervals.count()) {
+                cursor = intervals[interval].first;
+            }
+        } else {
+            cursor = cursor.next();
+        }
+        return current;
+    }
+
+    if (address < addresses.count()) {
+        return addresses[address++];
+    }
+
+    const Pattern &current = patterns[pattern];
+    const IpAddress result(current.network + subnet, suffix);
+    if (suffix != current.lastSuffix) {
+        suffix++;
+    } else if (++subnet < current.subnets) {
+        suffix = current.firstSuffix;
+    } else {
+        subnet = 0;
+        if (++pattern < patterns.count()) {
+            suffix = patterns[pattern].firstSuffix;
+        }
+    }
+    return result;
+}
+
+quint64 AddressSet::remaining() const
+{
+    return consumed < total ? total - consumed : 0;
+}
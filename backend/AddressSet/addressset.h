@@ -0,0 +1,71 @@
+#ifndef ADDRESSSET_H
+#define ADDRESSSET_H
+
+#include "../IpAddress/ipaddress.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QPair>
+
+// Set of IPv4 and IPv6 addresses. Entries may be CIDR blocks (10.0.0.0/8,
+// 2001:db8::/120), dash ranges (10.0.0.1-10.0.3.255, 10.0.0.1-254,
+// 2001:db8::1-ff), single addresses, or prefix and suffix patterns
+// (2001:db8::/48@::1-::3) which take the given interface identifiers in every
+// /64 under the prefix.
+//
+// Ranges are kept as sorted, merged intervals, so no address is walked twice,
+// and single addresses are stored apart at 16 bytes each, so long lists of
+// sparse IPv6 targets stay compact. Patterns are never expanded either: they
+// are cut into disjoint rectangles of subnets by suffixes, without what the
+// intervals cover, and the addresses of the whole set are produced on demand.
+class AddressSet
+{
+public:
+    AddressSet();
+
+    void insert(const IpAddress &first, const IpAddress &last);
+    bool insert(const QByteArray &entry);
+    int insertList(const QByteArray &list);
+    bool insertFile(const QString &fileName, int *invalidEntries = nullptr);
+    void normalize();
+
+    bool isEmpty() const;
+    quint64 size() const;
+    // Once normalized
+    bool contains(const IpAddress &address) const;
+
+    void rewind();
+    void seek(quint64 position);
+    bool hasNext() const;
+    IpAddress next();
+    quint64 remaining() const;
+
+private:
+    struct Pattern {
+        quint64 network;
+        quint64 subnets;
+        quint64 firstSuffix;
+        quint64 lastSuffix;
+        bool operator<(const Pattern &other) const;
+    };
+
+    bool insertPattern(const QByteArray &prefix, const QByteArray &suffixes);
+    void normalizePatterns();
+    bool patternsContain(const IpAddress &address) const;
+
+    QVector<QPair<IpAddress, IpAddress>> intervals;
+    QVector<IpAddress> addresses;
+    QVector<Pattern> patterns;
+    quint64 total = 0;
+
+    // Iteration: the intervals first, then the single addresses and the patterns
+    int interval = 0;
+    IpAddress cursor;
+    int address = 0;
+    int pattern = 0;
+    quint64 subnet = 0;
+    quint64 suffix = 0;
+    quint64 consumed = 0;
+};
+
+#endif // ADDRESSSET_H
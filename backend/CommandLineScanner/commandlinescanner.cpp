@@ -0,0 +1,350 @@
+#include "commandlinescanner.h"
+#include <QCommandLineParser>
+#include <stdio.h>
+#include <limits>
+
+CommandLineScanner::CommandLineScanner(QObject *parent) : QObject(parent), out(stdout)
+{
+    // Results are written straight from the finder thread, so they are never
+    // queued behind the main event loop
+    connect(&finder, &ThreadedFinder::checkReplied, this, &CommandLineScanner::onCheckReplied, Qt::DirectConnection);
+    connect(&finder, &ThreadedFinder::finished, this, &CommandLineScanner::onFinderFinished);
+}
+
+CommandLineScanner::~CommandLineScanner()
+{
+    finder.quit();
+    finder.wait();
+}
+
+bool CommandLineScanner::isHeadless(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CommandLineScanner::configure(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Scans address ranges for open proxies.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("targets", "CIDR blocks, ranges or addresses to scan.", "[targets...]");
+
+    const QCommandLineOption headlessOption("headless", "Run without the graphical interface.");
+    const QCommandLineOption targetsFileOption(QStringList() << "f" << "targets-file", "Read the targets from <file>, one entry per line.", "file");
+    const QCommandLineOption portsOption(QStringList() << "p" << "ports", "Ports to check on every address, as in 80,3128,8000-8100.", "ports", "80,3128,8080");
+    const QCommandLineOption timeoutOption(QStringList() << "t" << "timeout", "Timeout of every check, in milliseconds.", "ms", QString::number(finder.getTimeout()));
+    const QCommandLineOption minTimeoutOption("min-timeout", "Shortest timeout the round trip times may lead to, in milliseconds.", "ms", QString::number(finder.getMinTimeout()));
+    const QCommandLineOption fixedTimeoutOption("fixed-timeout", "Give every check the whole timeout instead of adapting it.");
+    const QCommandLineOption connectTimeoutOption("connect-timeout", "Try a plain TCP connection first, for <ms> milliseconds. 0 disables it.", "ms", QString::number(finder.getConnectTimeout()));
+    const QCommandLineOption concurrencyOption(QStringList() << "c" << "concurrency", "Maximum number of checks in flight.", "n", QString::number(finder.getNumberOfThreads()));
+    const QCommandLineOption minConcurrencyOption("min-concurrency", "Minimum number of checks in flight, the window adapts between both.", "n", QString::number(finder.getMinThreads()));
+    const QCommandLineOption fixedConcurrencyOption("fixed-concurrency", "Keep the maximum number of checks in flight instead of adapting it.");
+    const QCommandLineOption rateOption(QStringList() << "r" << "rate", "Maximum number of checks started per second, 0 without limit.", "n", QString::number(finder.getRateLimit()));
+    const QCommandLineOption burstOption("burst", "Checks that may start at once under the rate limit.", "n", QString::number(finder.getRateBurst()));
+    const QCommandLineOption workersOption(QStringList() << "w" << "workers", "Number of worker threads.", "n", QString::number(finder.getWorkerThreads()));
+    const QCommandLineOption typeOption("type", "Request type: http, https, ftp, or detect to find out the protocols of every port (Linux only).", "type", "http");
+    const QCommandLineOption urlOption("url", "URL requested through every proxy.", "url", finder.getRequestUrl());
+    const QCommandLineOption engineOption("engine", "Probe engine: qt or native.", "engine", "qt");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "Also append every result to <file>.", "file");
+    const QCommandLineOption formatOption("format", "Format of the output file: ndjson or csv.", "format", "ndjson");
+    const QCommandLineOption checkpointOption("checkpoint", "Save the progress to <file> and resume from it when it matches the scan.", "file");
+    const QCommandLineOption cacheOption("cache", "Remember the outcome of every host in <file>, skipping the dead ones and checking the live ones first.", "file");
+    const QCommandLineOption liveTtlOption("live-ttl", "Minutes a live proxy is remembered.", "min", QString::number(finder.getLiveTtl()));
+    const QCommandLineOption refusedTtlOption("refused-ttl", "Minutes a refusing host is skipped.", "min", QString::number(finder.getRefusedTtl()));
+    const QCommandLineOption deadTtlOption("dead-ttl", "Minutes a host that never answered is skipped.", "min", QString::number(finder.getDeadTtl()));
+    const QCommandLineOption benchmarkOption("benchmark", "Measure the proxies found: connection time, time to first byte, throughput and anonymity, written to the output file.");
+    const QCommandLineOption samplesOption("samples", "Samples taken of every proxy benchmarked.", "n", QString::number(finder.getBenchmarkSamples()));
+    const QCommandLineOption judgeOption("judge", "Page echoing the request headers, to judge the anonymity of the proxies.", "url", finder.getJudgeUrl());
+    const QCommandLineOption revalidateOption("revalidate", "Keep the proxies found in <file>, a results file or this output, fresh instead of scanning.", "file");
+    const QCommandLineOption intervalOption("interval", "Seconds between two checks of the same proxy when revalidating.", "s", "300");
+    const QCommandLineOption jitterOption("jitter", "Percentage of the interval the checks are moved by, at random.", "percent", "20");
+    const QCommandLineOption maxFailuresOption("max-failures", "Failed checks in a row after which a proxy is evicted.", "n", "3");
+    const QCommandLineOption roundsOption("rounds", "Checks of every proxy before exiting, 0 to keep revalidating.", "n", "0");
+    const QCommandLineOption liveOption("live", "Keep <file> updated with the live proxies while revalidating.", "file");
+    const QCommandLineOption allOption(QStringList() << "a" << "all", "Print every result, not only the working proxies.");
+    parser.addOptions({ headlessOption, targetsFileOption, portsOption, timeoutOption, minTimeoutOption,
+                        fixedTimeoutOption, connectTimeoutOption,
+                        concurrencyOption, minConcurrencyOption, fixedConcurrencyOption, rateOption, burstOption,
+                        workersOption, typeOption, urlOption, engineOption,
+                        outputOption, formatOption, checkpointOption,
+                        cacheOption, liveTtlOption, refusedTtlOption, deadTtlOption,
+                        benchmarkOption, samplesOption, judgeOption,
+                        revalidateOption, intervalOption, jitterOption, maxFailuresOption, roundsOption, liveOption, allOption });
+
+    // Exits right away on --help, --version or an unknown option
+    parser.process(arguments);
+
+    QTextStream err(stderr);
+
+    finder.setTargets(parser.positionalArguments().join(','));
+    finder.setTargetsFile(parser.value(targetsFileOption));
+    const bool revalidating = parser.isSet(revalidateOption);
+    if (!revalidating && parser.positionalArguments().isEmpty() && parser.value(targetsFileOption).isEmpty()) {
+        err << "No targets given" << endl;
+        return false;
+    }
+    if (!revalidating && !finder.getValidTargets()) {
+        err << "Invalid targets" << endl;
+        return false;
+    }
+
+    finder.setPorts(parser.value(portsOption));
+    if (!finder.getValidPorts()) {
+        err << "Invalid ports: " << parser.value(portsOption) << endl;
+        return false;
+    }
+
+    bool ok = true;
+    const int timeout = parser.value(timeoutOption).toInt(&ok);
+    if (!ok || timeout <= 0) {
+        err << "Invalid timeout: " << parser.value(timeoutOption) << endl;
+        return false;
+    }
+    finder.setTimeout(timeout);
+
+    const int minTimeout = parser.value(minTimeoutOption).toInt(&ok);
+    if (!ok || minTimeout <= 0) {
+        err << "Invalid minimum timeout: " << parser.value(minTimeoutOption) << endl;
+        return false;
+    }
+    finder.setMinTimeout(minTimeout);
+    finder.setAdaptiveTimeout(!parser.isSet(fixedTimeoutOption));
+
+    const int connectTimeout = parser.value(connectTimeoutOption).toInt(&ok);
+    if (!ok || connectTimeout < 0) {
+        err << "Invalid connect timeout: " << parser.value(connectTimeoutOption) << endl;
+        return false;
+    }
+    finder.setConnectSweep(connectTimeout > 0);
+    if (connectTimeout > 0) {
+        finder.setConnectTimeout(connectTimeout);
+    }
+
+    const uint concurrency = parser.value(concurrencyOption).toUInt(&ok);
+    if (!ok || concurrency == 0) {
+        err << "Invalid concurrency: " << parser.value(concurrencyOption) << endl;
+        return false;
+    }
+    finder.setNumberOfThreads(concurrency);
+
+    const uint minConcurrency = parser.value(minConcurrencyOption).toUInt(&ok);
+    if (!ok || minConcurrency == 0) {
+        err << "Invalid minimum concurrency: " << parser.value(minConcurrencyOption) << endl;
+        return false;
+    }
+    finder.setMinThreads(minConcurrency);
+    finder.setAdaptiveConcurrency(!parser.isSet(fixedConcurrencyOption));
+
+    const int rate = parser.value(rateOption).toInt(&ok);
+    if (!ok || rate < 0) {
+        err << "Invalid rate: " << parser.value(rateOption) << endl;
+        return false;
+    }
+    finder.setRateLimit(rate);
+
+    const int burst = parser.value(burstOption).toInt(&ok);
+    if (!ok || burst <= 0) {
+        err << "Invalid burst: " << parser.value(burstOption) << endl;
+        return false;
+    }
+    finder.setRateBurst(burst);
+
+    const int workers = parser.value(workersOption).toInt(&ok);
+    if (!ok || workers <= 0) {
+        err << "Invalid number of workers: " << parser.value(workersOption) << endl;
+        return false;
+    }
+    finder.setWorkerThreads(workers);
+
+    const QString type = parser.value(typeOption).toLower();
+    if (type == "http") {
+        finder.setRequestType(ThreadedFinder::HTTP);
+    } else if (type == "https") {
+        finder.setRequestType(ThreadedFinder::HTTPS);
+    } else if (type == "ftp") {
+        finder.setRequestType(ThreadedFinder::FTP);
+    } else if (type == "detect") {
+        finder.setRequestType(ThreadedFinder::Detect);
+    } else {
+        err << "Invalid request type: " << type << endl;
+        return false;
+    }
+    finder.setRequestUrl(parser.value(urlOption));
+
+    const QString engine = parser.value(engineOption).toLower();
+    if (engine == "qt") {
+        finder.setEngine(ThreadedFinder::QtNetwork);
+    } else if (engine == "native") {
+        finder.setEngine(ThreadedFinder::Native);
+    } else {
+        err << "Invalid engine: " << engine << endl;
+        return false;
+    }
+
+    finder.setOutputFile(parser.value(outputOption));
+    const QString format = parser.value(formatOption).toLower();
+    if (format == "ndjson") {
+        finder.setOutputFormat(ThreadedFinder::NDJSON);
+    } else if (format == "csv") {
+        finder.setOutputFormat(ThreadedFinder::CSV);
+    } else {
+        err << "Invalid output format: " << format << endl;
+        return false;
+    }
+
+    finder.setCheckpointFile(parser.value(checkpointOption));
+
+    finder.setHostCacheFile(parser.value(cacheOption));
+    finder.setUseHostCache(parser.isSet(cacheOption));
+    const int liveTtl = parser.value(liveTtlOption).toInt(&ok);
+    if (!ok || liveTtl <= 0) {
+        err << "Invalid live TTL: " << parser.value(liveTtlOption) << endl;
+        return false;
+    }
+    finder.setLiveTtl(liveTtl);
+
+    const int refusedTtl = parser.value(refusedTtlOption).toInt(&ok);
+    if (!ok || refusedTtl <= 0) {
+        err << "Invalid refused TTL: " << parser.value(refusedTtlOption) << endl;
+        return false;
+    }
+    finder.setRefusedTtl(refusedTtl);
+
+    const int deadTtl = parser.value(deadTtlOption).toInt(&ok);
+    if (!ok || deadTtl <= 0) {
+        err << "Invalid dead TTL: " << parser.value(deadTtlOption) << endl;
+        return false;
+    }
+    finder.setDeadTtl(deadTtl);
+
+    finder.setBenchmark(parser.isSet(benchmarkOption));
+    const int samples = parser.value(samplesOption).toInt(&ok);
+    if (!ok || samples <= 0 || samples > 255) {
+        err << "Invalid number of samples: " << parser.value(samplesOption) << endl;
+        return false;
+    }
+    finder.setBenchmarkSamples(samples);
+    finder.setJudgeUrl(parser.value(judgeOption));
+
+    printAll = parser.isSet(allOption);
+    if (!revalidating) {
+        return true;
+    }
+
+    const int interval = parser.value(intervalOption).toInt(&ok);
+    if (!ok || interval <= 0) {
+        err << "Invalid interval: " << parser.value(intervalOption) << endl;
+        return false;
+    }
+    const int jitter = parser.value(jitterOption).toInt(&ok);
+    if (!ok || jitter < 0 || jitter > 100) {
+        err << "Invalid jitter: " << parser.value(jitterOption) << endl;
+        return false;
+    }
+    const int maxFailures = parser.value(maxFailuresOption).toInt(&ok);
+    if (!ok || maxFailures <= 0) {
+        err << "Invalid maximum failures: " << parser.value(maxFailuresOption) << endl;
+        return false;
+    }
+    const int rounds = parser.value(roundsOption).toInt(&ok);
+    if (!ok || rounds < 0) {
+        err << "Invalid rounds: " << parser.value(roundsOption) << endl;
+        return false;
+    }
+
+    QSet<int> hitCodes;
+    for (const auto &code : finder.getFilteredCodes()) {
+        hitCodes.insert(code.toInt());
+    }
+    revalidator.reset(new Revalidator(finder.createProbeEngine()));
+    if (!revalidator->load(parser.value(revalidateOption), hitCodes)) {
+        err << "Unable to read " << parser.value(revalidateOption) << endl;
+        return false;
+    }
+    revalidator->setInterval(interval);
+    revalidator->setJitter(jitter / 100.0);
+    revalidator->setMaxFailures(maxFailures);
+    revalidator->setRounds(rounds);
+    revalidator->setConcurrency(int(qMin(concurrency, uint(std::numeric_limits<int>::max()))));
+    revalidator->setTimeout(timeout);
+    revalidator->setLiveFile(parser.value(liveOption));
+    revalidator->setOutputFile(finder.getOutputFile(), ResultSink::Format(finder.getOutputFormat()));
+
+    connect(revalidator.data(), &Revalidator::checked, this, &CommandLineScanner::onCheckReplied);
+    connect(revalidator.data(), &Revalidator::evicted, this, &CommandLineScanner::onEvicted);
+    connect(revalidator.data(), &Revalidator::finished, this, &CommandLineScanner::onFinderFinished);
+    return true;
+}
+
+void CommandLineScanner::start()
+{
+    checked = 0;
+    found = 0;
+    codes.clear();
+    for (const auto &code : finder.getFilteredCodes()) {
+        codes.insert(code.toInt());
+    }
+    if (revalidator) {
+        QTextStream(stderr) << "Revalidating " << revalidator->count() << " proxies" << endl;
+        revalidator->start();
+        return;
+    }
+    finder.start();
+}
+
+void CommandLineScanner::onCheckReplied(const IpAddress &address, unsigned short port, int error, const QString &reason)
+{
+    checked++;
+    if (!printAll && !codes.contains(error)) {
+        return;
+    }
+    found++;
+
+    const QString host = address.isIPv4() ? address.toString() : '[' + address.toString() + ']';
+    // Flushed on every line, so the results can be piped while the scan runs
+    out << host << ':' << port << '\t' << error << '\t' << reason << endl;
+}
+
+void CommandLineScanner::onEvicted(const IpAddress &address, unsigned short port, int failures)
+{
+    const QString host = address.isIPv4() ? address.toString() : '[' + address.toString() + ']';
+    QTextStream(stderr) << "Evicted " << host << ':' << port << " after " << failures << " failed checks, "
+                        << revalidator->liveCount() << " live" << endl;
+}
+
+// p50/p90/p99/max, in ms
+static QString latencySummary(const LatencyHistogram::Snapshot &histogram)
+{
+    if (histogram.count() == 0) {
+        return QStringLiteral("-");
+    }
+    return QString("%1/%2/%3/%4").arg(histogram.percentile(50) / 1000.0, 0, 'f', 1).arg(histogram.percentile(90) / 1000.0, 0, 'f', 1)
+                                 .arg(histogram.percentile(99) / 1000.0, 0, 'f', 1).arg(histogram.max() / 1000.0, 0, 'f', 1);
+}
+
+void CommandLineScanner::onFinderFinished()
+{
+    QTextStream err(stderr);
+    err << "Checked " << checked << " targets, " << found << " printed" << endl;
+    const ScanStatistics::Snapshot statistics = finder.statisticsSnapshot();
+    if (!revalidator && statistics.totalTime.count() > 0) {
+        err << "Latency p50/p90/p99/max (ms): connect " << latencySummary(statistics.connectTime)
+            << ", first byte " << latencySummary(statistics.firstByteTime)
+            << ", total " << latencySummary(statistics.totalTime) << endl;
+        QStringList outcomes;
+        for (auto it = statistics.outcomes.constBegin(); it != statistics.outcomes.constEnd(); ++it) {
+            outcomes << QString::number(it.key()) + ": " + QString::number(it.value());
+        }
+        err << "Outcomes by error code: " << outcomes.join(", ") << endl;
+    }
+    if (revalidator) {
+        QTextStream(stderr) << revalidator->liveCount() << " of " << revalidator->count() << " proxies live" << endl;
+    }
+    emit finished(0);
+}
@@ -0,0 +1,47 @@
+#ifndef COMMANDLINESCANNER_H
+#define COMMANDLINESCANNER_H
+
+#include "../ThreadedFinder/threadedfinder.h"
+#include "../Revalidator/revalidator.h"
+#include <QObject>
+#include <QStringList>
+#include <QSet>
+#include <QTextStream>
+#include <QScopedPointer>
+
+// Drives a ThreadedFinder from the command line, without the QML engine nor
+// a display. Results are written to stdout as they arrive, one per line:
+// address:port, the QNetworkReply error code and the reason, tab separated.
+// With --revalidate the proxies of a previous run are checked again on a
+// schedule instead.
+class CommandLineScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CommandLineScanner(QObject *parent = nullptr);
+    ~CommandLineScanner() override;
+
+    bool configure(const QStringList &arguments);
+    void start();
+
+    static bool isHeadless(int argc, char *argv[]);
+
+signals:
+    void finished(int exitCode);
+
+private:
+    void onCheckReplied(const IpAddress &address, unsigned short port, int error, const QString &reason);
+    void onEvicted(const IpAddress &address, unsigned short port, int failures);
+    void onFinderFinished();
+
+    ThreadedFinder finder;
+    QScopedPointer<Revalidator> revalidator;
+    QTextStream out;
+    bool printAll = false;
+    QSet<int> codes;
+    quint64 checked = 0;
+    quint64 found = 0;
+};
+
+#endif // COMMANDLINESCANNER_H
@@ -0,0 +1,115 @@
+#include "concurrencycontroller.h"
+#include <QNetworkReply>
+
+static const qint64 MinimumEpoch = 100; // ms, so the rates are meaningful
+static const double TimeoutMargin = 0.1;
+static const double BaselineGain = 0.125;
+static const double RateDrop = 0.8;
+static const int IncreaseSteps = 64; // epochs to cross the bounds additively
+
+ConcurrencyController::ConcurrencyController(int minimum, int maximum)
+{
+    setBounds(minimum, maximum);
+    reset(0);
+}
+
+int ConcurrencyController::getMinimum() const
+{
+    return minimum;
+}
+
+int ConcurrencyController::getMaximum() const
+{
+    return maximum;
+}
+
+void ConcurrencyController::setBounds(int minimumWindow, int maximumWindow)
+{
+    minimum = qMax(1, minimumWindow);
+    maximum = qMax(minimum, maximumWindow);
+    resize(window);
+}
+
+int ConcurrencyController::getWindow() const
+{
+    return int(window);
+}
+
+void ConcurrencyController::reset(qint64 now)
+{
+    window = minimum;
+    slowStart = true;
+    raised = false;
+    epochStart = now;
+    epochCompleted = 0;
+    epochTimeouts = 0;
+    epochLocalErrors = 0;
+    lastRate = 0;
+    timeoutBaseline = -1;
+}
+
+bool ConcurrencyController::onCompleted(Outcome outcome, qint64 now)
+{
+    epochCompleted++;
+    if (outcome == TimedOut) {
+        epochTimeouts++;
+    } else if (outcome == LocalError) {
+        epochLocalErrors++;
+    }
+
+    // Running out of sockets doesn't wait for the whole window to complete
+    if ((epochCompleted < getWindow() && epochLocalErrors == 0) || now - epochStart < MinimumEpoch) {
+        return false;
+    }
+
+    const int previous = getWindow();
+    endEpoch(now);
+    return getWindow() != previous;
+}
+
+ConcurrencyController::Outcome ConcurrencyController::outcomeFromError(int error)
+{
+    switch (error) {
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::OperationCanceledError: // aborted by the check timeout
+        return TimedOut;
+    case QNetworkReply::TemporaryNetworkFailureError:
+        return LocalError;
+    default:
+        return Answered;
+    }
+}
+
+void ConcurrencyController::endEpoch(qint64 now)
+{
+    const double rate = epochCompleted * 1000.0 / qMax(now - epochStart, qint64(1));
+    const double timeoutRatio = double(epochTimeouts) / epochCompleted;
+
+    if (epochLocalErrors > 0) {
+        slowStart = false;
+        raised = false;
+        resize(window / 2);
+    } else if ((timeoutBaseline >= 0 && timeoutRatio > timeoutBaseline + TimeoutMargin)
+               || (raised && rate < lastRate * RateDrop)) {
+        // Timeouts caused by the scan itself and not by the targets
+        slowStart = false;
+        raised = false;
+        resize(window * 0.75);
+    } else {
+        timeoutBaseline = timeoutBaseline < 0 ? timeoutRatio : timeoutBaseline + BaselineGain * (timeoutRatio - timeoutBaseline);
+        raised = getWindow() < maximum;
+        resize(slowStart ? window * 2 : window + qMax(1.0, double(maximum - minimum) / IncreaseSteps));
+    }
+
+    lastRate = rate;
+    epochStart = now;
+    epochCompleted = 0;
+    epochTimeouts = 0;
+    epochLocalErrors = 0;
+}
+
+void ConcurrencyController::resize(double value)
+{
+    window = qBound(double(minimum), value, double(maximum));
+}
@@ -0,0 +1,51 @@
+#ifndef CONCURRENCYCONTROLLER_H
+#define CONCURRENCYCONTROLLER_H
+
+#include <QtGlobal>
+
+// Window of checks in flight, tuned while scanning with additive increase and
+// multiplicative decrease, as TCP does with its congestion window. Completions
+// are evaluated in epochs of about one window: local socket errors (file
+// descriptors or ports exhausted) halve the window, while a timeout ratio
+// clearly above the usual one of the scan or a completion rate falling after
+// a raise shrink it by a quarter. Healthy epochs grow it, doubling it until
+// the first decrease. The window never leaves the user bounds.
+class ConcurrencyController
+{
+public:
+    enum Outcome { Answered, TimedOut, LocalError };
+
+    explicit ConcurrencyController(int minimum = 1, int maximum = 300);
+
+    int getMinimum() const;
+    int getMaximum() const;
+    void setBounds(int minimumWindow, int maximumWindow);
+
+    int getWindow() const;
+
+    // Times are in milliseconds, of any monotonic clock
+    void reset(qint64 now);
+    // Returns whether the window changed
+    bool onCompleted(Outcome outcome, qint64 now);
+
+    static Outcome outcomeFromError(int error);
+
+private:
+    void endEpoch(qint64 now);
+    void resize(double value);
+
+    int minimum = 1;
+    int maximum = 300;
+    double window = 1;
+    bool slowStart = true;
+    bool raised = false; // the last epoch ended with a raise
+
+    qint64 epochStart = 0;
+    int epochCompleted = 0;
+    int epochTimeouts = 0;
+    int epochLocalErrors = 0;
+    double lastRate = 0; // completions per second of the last epoch
+    double timeoutBaseline = -1; // smoothed timeout ratio of the healthy epochs, -1 until the first one
+};
+
+#endif // CONCURRENCYCONTROLLER_H
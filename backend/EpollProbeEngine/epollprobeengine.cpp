@@ -0,0 +1,564 @@
+#include "epollprobeengine.h"
+#include <QNetworkReply>
+#include <QUrl>
+#include <QDebug>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+static const quint64 WakeToken = ~quint64(0);
+static const int MaxEvents = 256;
+
+// Reset instead of the graceful close, so no local port is left in TIME_WAIT
+static void closeWithReset(int fd)
+{
+    linger reset;
+    reset.l_onoff = 1;
+    reset.l_linger = 0;
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    close(fd);
+}
+
+//! EpollProbeWorker
+EpollProbeWorker::EpollProbeWorker(const QByteArray &proxyRequest, const ProtocolDetector *protocolDetector,
+                                   int connectionTimeout, int tcpConnectTimeout, QObject *parent)
+    : QThread(parent)
+{
+    request = proxyRequest;
+    detector = protocolDetector;
+    timeout = connectionTimeout;
+    connectTimeout = tcpConnectTimeout;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        qWarning() << "EpollProbeWorker: Unable to create the event loop:" << strerror(errno);
+        return;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = WakeToken;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+EpollProbeWorker::~EpollProbeWorker()
+{
+    shutdown();
+    wait();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+void EpollProbeWorker::run()
+{
+    if (epollFd < 0 || wakeFd < 0) {
+        return;
+    }
+
+    clock.start();
+    epoll_event events[MaxEvents];
+    while (!shutdownRequested.loadAcquire()) {
+        const qint64 nextDeadline = deadlines.nextExpiry();
+        const int waitTime = nextDeadline < 0 ? -1 : int(qMax<qint64>(0, nextDeadline - clock.elapsed()));
+
+        const int count = epoll_wait(epollFd, events, MaxEvents, waitTime);
+        if (count < 0 && errno != EINTR) {
+            qWarning() << "EpollProbeWorker: epoll_wait failed:" << strerror(errno);
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const quint64 data = events[i].data.u64;
+            if (data == WakeToken) {
+                eventfd_t value;
+                eventfd_read(wakeFd, &value);
+                continue;
+            }
+            // Skip the events of checks finished earlier in this same batch
+            const int slot = int(data & 0xFFFFFFFF);
+            if (probes[slot].state != Free && probes[slot].generation == quint32(data >> 32)) {
+                onEvent(slot, events[i].events);
+            }
+        }
+
+        if (abortRequested.testAndSetOrdered(1, 0)) {
+            closeAll();
+        }
+
+        QVector<Target> targets;
+        mutex.lock();
+        targets.swap(incoming);
+        mutex.unlock();
+        for (const Target &target : targets) {
+            launch(target);
+        }
+
+        expire(clock.elapsed());
+    }
+    closeAll();
+}
+
+void EpollProbeWorker::enqueue(quint64 sequence, const IpAddress &address, unsigned short port, int checkTimeout)
+{
+    mutex.lock();
+    const bool wasEmpty = incoming.isEmpty();
+    incoming.append({ sequence, address, port, checkTimeout > 0 ? checkTimeout : timeout });
+    mutex.unlock();
+
+    // The loop takes the whole queue at once, so it only needs to be woken up once
+    if (wasEmpty) {
+        wake();
+    }
+}
+
+void EpollProbeWorker::abort()
+{
+    mutex.lock();
+    incoming.clear();
+    mutex.unlock();
+    abortRequested.storeRelease(1);
+    wake();
+}
+
+void EpollProbeWorker::shutdown()
+{
+    shutdownRequested.storeRelease(1);
+    wake();
+}
+
+void EpollProbeWorker::setStatistics(ScanStatistics::Shard *shard)
+{
+    statistics.storeRelease(shard);
+}
+
+void EpollProbeWorker::wake()
+{
+    if (wakeFd >= 0) {
+        eventfd_write(wakeFd, 1);
+    }
+}
+
+void EpollProbeWorker::launch(const Target &target)
+{
+    int slot;
+    if (freeSlots.isEmpty()) {
+        slot = probes.count();
+        probes.append(Probe());
+    } else {
+        slot = freeSlots.takeLast();
+    }
+
+    Probe &probe = probes[slot];
+    probe.target = target;
+    probe.detection = ProtocolDetector::State();
+    connectProbe(slot);
+}
+
+void EpollProbeWorker::connectProbe(int slot)
+{
+    Probe &probe = probes[slot];
+    const Target &target = probe.target;
+    probe.generation++;
+    probe.sent = 0;
+    probe.received = 0;
+    probe.state = Connecting;
+    // IPv4 targets use plain IPv4 sockets, so they work on hosts without IPv6
+    sockaddr_storage address;
+    socklen_t addressLength;
+    memset(&address, 0, sizeof(address));
+    if (target.address.isIPv4()) {
+        sockaddr_in *ipv4 = reinterpret_cast<sockaddr_in*>(&address);
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(target.port);
+        ipv4->sin_addr.s_addr = htonl(target.address.toIPv4());
+        addressLength = sizeof(sockaddr_in);
+    } else {
+        sockaddr_in6 *ipv6 = reinterpret_cast<sockaddr_in6*>(&address);
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(target.port);
+        for (int i = 0; i < 8; ++i) {
+            ipv6->sin6_addr.s6_addr[i] = quint8(target.address.high() >> (56 - 8 * i));
+            ipv6->sin6_addr.s6_addr[i + 8] = quint8(target.address.low() >> (56 - 8 * i));
+        }
+        addressLength = sizeof(sockaddr_in6);
+    }
+
+    probe.stageStartedAt = clock.nsecsElapsed();
+    probe.fd = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (probe.fd < 0) {
+        failWithErrno(slot, errno);
+        return;
+    }
+    if (::connect(probe.fd, reinterpret_cast<sockaddr*>(&address), addressLength) < 0 && errno != EINPROGRESS) {
+        failWithErrno(slot, errno);
+        return;
+    }
+
+    // Writable once connected, or with an error pending
+    epoll_event event;
+    event.events = EPOLLOUT;
+    event.data.u64 = token(slot);
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, probe.fd, &event) < 0) {
+        failWithErrno(slot, errno);
+        return;
+    }
+    deadlines.cancel(probe.timer);
+    const int stageTimeout = connectTimeout > 0 ? qMin(connectTimeout, target.timeout) : target.timeout;
+    probe.timer = deadlines.start(clock.elapsed() + stageTimeout, token(slot));
+}
+
+void EpollProbeWorker::onEvent(int slot, quint32 events)
+{
+    Probe &probe = probes[slot];
+
+    if (probe.state == Connecting) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            failWithErrno(slot, error);
+            return;
+        }
+        probe.state = Sending;
+        if (ScanStatistics::Shard *shard = statistics.loadAcquire()) {
+            shard->connectTime.record(quint32((clock.nsecsElapsed() - probe.stageStartedAt) / 1000));
+        }
+
+        // Second stage: the proxy check has the whole timeout once connected
+        if (connectTimeout > 0) {
+            deadlines.cancel(probe.timer);
+            probe.timer = deadlines.start(clock.elapsed() + probe.target.timeout, token(slot));
+        }
+    }
+
+    if (probe.state == Sending) {
+        const QByteArray &data = payload(probe);
+        while (probe.sent < data.size()) {
+            const ssize_t n = send(probe.fd, data.constData() + probe.sent, size_t(data.size() - probe.sent), MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    failWithErrno(slot, errno);
+                }
+                return;
+            }
+            probe.sent += int(n);
+        }
+
+        probe.state = Receiving;
+        probe.stageStartedAt = clock.nsecsElapsed();
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = token(slot);
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, probe.fd, &event);
+        return;
+    }
+
+    if (probe.state == Receiving) {
+        for (;;) {
+            const ssize_t n = recv(probe.fd, probe.buffer + probe.received, sizeof(probe.buffer) - size_t(probe.received), 0);
+            if (n > 0) {
+                if (probe.received == 0) {
+                    if (ScanStatistics::Shard *shard = statistics.loadAcquire()) {
+                        shard->firstByteTime.record(quint32((clock.nsecsElapsed() - probe.stageStartedAt) / 1000));
+                    }
+                }
+                probe.received += int(n);
+                const bool complete = detector ? detector->isComplete(probe.detection.stage, probe.buffer, probe.received)
+                                               : memchr(probe.buffer, '\n', size_t(probe.received)) != nullptr;
+                if (complete || probe.received == int(sizeof(probe.buffer))) {
+                    onAnswer(slot);
+                    return;
+                }
+            } else if (n == 0) {
+                if (probe.received > 0) {
+                    onAnswer(slot);
+                } else if (detector) {
+                    advance(slot, detector->onClosed(probe.detection));
+                } else {
+                    finish(slot, QNetworkReply::ProxyConnectionClosedError, QStringLiteral("Proxy connection closed prematurely"));
+                }
+                return;
+            } else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    failWithErrno(slot, errno);
+                } else if (events & (EPOLLERR | EPOLLHUP)) {
+                    failWithErrno(slot, ECONNRESET);
+                }
+                return;
+            }
+        }
+    }
+}
+
+void EpollProbeWorker::onAnswer(int slot)
+{
+    if (detector) {
+        Probe &probe = probes[slot];
+        advance(slot, detector->onAnswer(probe.detection, probe.buffer, probe.received));
+    } else {
+        onStatusLine(slot);
+    }
+}
+
+void EpollProbeWorker::onStatusLine(int slot)
+{
+    // Expected: HTTP/1.x <code> <reason phrase>
+    const Probe &probe = probes[slot];
+    const QByteArray line = QByteArray::fromRawData(probe.buffer, probe.received).split('\n').first().trimmed();
+    const int firstSpace = line.indexOf(' ');
+    bool ok = false;
+    const int statusCode = firstSpace < 0 ? 0 : line.mid(firstSpace + 1, 3).toInt(&ok);
+    if (!line.startsWith("HTTP/") || !ok) {
+        finish(slot, QNetworkReply::ProtocolFailure, QStringLiteral("Protocol error"));
+        return;
+    }
+    finish(slot, ProtocolDetector::errorFromStatusCode(statusCode), QString::fromLatin1(line.mid(firstSpace + 5).trimmed()));
+}
+
+void EpollProbeWorker::advance(int slot, ProtocolDetector::Action action)
+{
+    Probe &probe = probes[slot];
+    switch (action) {
+    case ProtocolDetector::SendOnSameConnection: {
+        // The next request goes on the same connection, with a timeout of its own
+        probe.state = Sending;
+        probe.sent = 0;
+        probe.received = 0;
+        epoll_event event;
+        event.events = EPOLLOUT;
+        event.data.u64 = token(slot);
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, probe.fd, &event);
+        deadlines.cancel(probe.timer);
+        probe.timer = deadlines.start(clock.elapsed() + probe.target.timeout, token(slot));
+        break;
+    }
+    case ProtocolDetector::Reconnect:
+        closeWithReset(probe.fd);
+        probe.fd = -1;
+        connectProbe(slot);
+        break;
+    case ProtocolDetector::Finish:
+        finishDetection(slot);
+        break;
+    }
+}
+
+void EpollProbeWorker::finishDetection(int slot)
+{
+    QString reason;
+    const int error = ProtocolDetector::error(probes[slot].detection, &reason);
+    finish(slot, error, reason);
+}
+
+void EpollProbeWorker::finish(int slot, int error, const QString &reason)
+{
+    Probe &probe = probes[slot];
+    if (probe.fd >= 0) {
+        closeWithReset(probe.fd);
+        probe.fd = -1;
+    }
+    deadlines.cancel(probe.timer);
+    probe.state = Free;
+    freeSlots.append(slot);
+
+    emit replied(probe.target.sequence, probe.target.address, probe.target.port, error, reason, probe.detection.protocols);
+}
+
+void EpollProbeWorker::finishWithErrno(int slot, int errorNumber)
+{
+    switch (errorNumber) {
+    case ECONNREFUSED:
+        finish(slot, QNetworkReply::ProxyConnectionRefusedError, QStringLiteral("Proxy connection refused"));
+        break;
+    case ECONNRESET:
+    case EPIPE:
+        finish(slot, QNetworkReply::ProxyConnectionClosedError, QStringLiteral("Proxy connection closed prematurely"));
+        break;
+    case ETIMEDOUT:
+        finish(slot, QNetworkReply::ProxyTimeoutError, QStringLiteral("Proxy server connection timed out"));
+        break;
+    case EHOSTUNREACH:
+    case ENETUNREACH:
+    case EAFNOSUPPORT:
+        finish(slot, QNetworkReply::ProxyNotFoundError, QStringLiteral("Proxy not found"));
+        break;
+    case EMFILE:
+    case ENFILE:
+    case ENOBUFS:
+    case ENOMEM:
+    case EADDRNOTAVAIL:
+        // Out of descriptors or local ports, the proxy wasn't even tried
+        finish(slot, QNetworkReply::TemporaryNetworkFailureError, QString::fromLocal8Bit(strerror(errorNumber)));
+        break;
+    default:
+        finish(slot, QNetworkReply::UnknownNetworkError, QString::fromLocal8Bit(strerror(errorNumber)));
+    }
+}
+
+void EpollProbeWorker::failWithErrno(int slot, int errorNumber)
+{
+    const Probe &probe = probes[slot];
+    if (!detector || probe.detection.stage == ProtocolDetector::Done) {
+        finishWithErrno(slot, errorNumber);
+    } else if (probe.state != Connecting && probe.fd >= 0) {
+        // Dropped by a host not speaking what was sent
+        advance(slot, detector->onClosed(probes[slot].detection));
+    } else if (probe.detection.stage == ProtocolDetector::Socks5Greeting) {
+        finishWithErrno(slot, errorNumber);
+    } else {
+        // Reconnecting failed, what was found so far is the answer
+        advance(slot, ProtocolDetector::Finish);
+    }
+}
+
+const QByteArray &EpollProbeWorker::payload(const Probe &probe) const
+{
+    return detector ? detector->request(probe.detection.stage) : request;
+}
+
+void EpollProbeWorker::expire(qint64 now)
+{
+    expired.clear();
+    deadlines.advance(now, expired);
+    for (quint64 data : expired) {
+        const int slot = int(data & 0xFFFFFFFF);
+        const Probe &probe = probes[slot];
+        if (probe.state == Free || probe.generation != quint32(data >> 32)) {
+            continue;
+        }
+        // Still within the connect timeout of the sweep, or out of the timeout of the check
+        if (detector && probe.detection.protocols) {
+            finishDetection(slot);
+        } else if (connectTimeout > 0 && probe.state == Connecting) {
+            finish(slot, QNetworkReply::ProxyTimeoutError, QStringLiteral("Proxy server connection timed out"));
+        } else {
+            finish(slot, QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+        }
+    }
+}
+
+void EpollProbeWorker::closeAll()
+{
+    // Reset as on a timeout, and answered as cancelled like every check must be
+    for (int slot = 0; slot < probes.count(); ++slot) {
+        if (probes[slot].state != Free) {
+            finish(slot, QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+        }
+    }
+    deadlines.clear();
+}
+
+quint64 EpollProbeWorker::token(int slot) const
+{
+    return (quint64(probes[slot].generation) << 32) | quint32(slot);
+}
+
+//! EpollProbeEngine
+EpollProbeEngine::EpollProbeEngine(const QByteArray &proxyRequest, int connectionTimeout, int tcpConnectTimeout,
+                                   int workerCount, QObject *parent)
+    : ProbeEngine(parent)
+{
+    startWorkers(proxyRequest, connectionTimeout, tcpConnectTimeout, workerCount);
+}
+
+EpollProbeEngine::EpollProbeEngine(const ProtocolDetector &protocolDetector, int connectionTimeout, int tcpConnectTimeout,
+                                   int workerCount, QObject *parent)
+    : ProbeEngine(parent), detector(new ProtocolDetector(protocolDetector))
+{
+    startWorkers(QByteArray(), connectionTimeout, tcpConnectTimeout, workerCount);
+}
+
+EpollProbeEngine::~EpollProbeEngine()
+{
+    for (auto worker : workers) {
+        worker->shutdown();
+    }
+    for (auto worker : workers) {
+        worker->wait();
+    }
+}
+
+int EpollProbeEngine::getWorkerCount() const
+{
+    return workers.count();
+}
+
+void EpollProbeEngine::setStatistics(ScanStatistics *statistics)
+{
+    for (auto worker : workers) {
+        worker->setStatistics(statistics ? statistics->createShard() : nullptr);
+    }
+}
+
+QByteArray EpollProbeEngine::proxyRequest(const QString &scheme, const QString &url)
+{
+    const QUrl target(scheme + "://" + url);
+    const QByteArray host = target.host(QUrl::FullyEncoded).toLatin1();
+
+    // HTTPS goes through a tunnel, anything else is forwarded by the proxy
+    if (scheme == "https") {
+        const QByteArray authority = host + ':' + QByteArray::number(target.port(443));
+        return "CONNECT " + authority + " HTTP/1.1\r\n"
+               "Host: " + authority + "\r\n"
+               "User-Agent: Requester\r\n\r\n";
+    }
+
+    QByteArray absoluteUri = target.toEncoded(QUrl::RemoveFragment);
+    if (target.path().isEmpty()) {
+        absoluteUri += '/';
+    }
+    return "GET " + absoluteUri + " HTTP/1.1\r\n"
+           "Host: " + host + "\r\n"
+           "User-Agent: Requester\r\n"
+           "Connection: close\r\n\r\n";
+}
+
+void EpollProbeEngine::start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout)
+{
+    workers[nextWorker]->enqueue(sequence, address, port, timeout);
+    nextWorker = (nextWorker + 1) % workers.count();
+}
+
+void EpollProbeEngine::stop()
+{
+    for (auto worker : workers) {
+        worker->abort();
+    }
+}
+
+void EpollProbeEngine::startWorkers(const QByteArray &proxyRequest, int connectionTimeout, int tcpConnectTimeout, int workerCount)
+{
+    raiseOpenFilesLimit();
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        EpollProbeWorker *worker = new EpollProbeWorker(proxyRequest, detector.data(), connectionTimeout, tcpConnectTimeout, this);
+        connect(worker, &EpollProbeWorker::replied, this, &EpollProbeEngine::replied);
+        workers.append(worker);
+        worker->start();
+    }
+}
+
+void EpollProbeEngine::raiseOpenFilesLimit()
+{
+    // Every check in flight holds a socket
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
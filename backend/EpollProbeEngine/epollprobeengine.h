@@ -0,0 +1,133 @@
+#ifndef EPOLLPROBEENGINE_H
+#define EPOLLPROBEENGINE_H
+
+#include "../ProbeEngine/probeengine.h"
+#include "../TimerWheel/timerwheel.h"
+#include "../ProtocolDetector/protocoldetector.h"
+#include "../ScanStatistics/scanstatistics.h"
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QPair>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QScopedPointer>
+
+// Event loop of a single core: non-blocking sockets multiplexed with epoll.
+// Each check connects to the proxy, writes the precomputed request and only
+// parses the status line of the answer. With a connect timeout the connection
+// gets its own deadline, and the proxy check starts its timeout once connected.
+// Every check has a single deadline at a time in the timer wheel of the worker.
+// With a protocol detector, the check walks through its stages instead,
+// reconnecting whenever the detector asks for it.
+class EpollProbeWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit EpollProbeWorker(const QByteArray &proxyRequest, const ProtocolDetector *protocolDetector = nullptr,
+                              int connectionTimeout = 2000, int tcpConnectTimeout = 0, QObject *parent = nullptr);
+    ~EpollProbeWorker() override;
+
+    void run() override;
+
+    // Thread safe
+    void enqueue(quint64 sequence, const IpAddress &address, unsigned short port, int checkTimeout);
+    void abort();
+    void shutdown();
+    void setStatistics(ScanStatistics::Shard *shard);
+
+signals:
+    void replied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols);
+
+private:
+    struct Target {
+        quint64 sequence;
+        IpAddress address;
+        unsigned short port;
+        int timeout;
+    };
+    enum State { Free, Connecting, Sending, Receiving };
+    struct Probe {
+        Target target;
+        int fd = -1;
+        State state = Free;
+        quint32 generation = 0;
+        quint64 timer = 0;
+        qint64 stageStartedAt = 0; // ns, of the connection or the request
+        ProtocolDetector::State detection;
+        int sent = 0;
+        int received = 0;
+        char buffer[128];
+    };
+
+    void wake();
+    void launch(const Target &target);
+    void connectProbe(int slot);
+    void onEvent(int slot, quint32 events);
+    void onAnswer(int slot);
+    void onStatusLine(int slot);
+    void advance(int slot, ProtocolDetector::Action action);
+    void finishDetection(int slot);
+    void finish(int slot, int error, const QString &reason);
+    void finishWithErrno(int slot, int errorNumber);
+    void failWithErrno(int slot, int errorNumber);
+    const QByteArray &payload(const Probe &probe) const;
+    void expire(qint64 now);
+    void closeAll();
+    quint64 token(int slot) const;
+
+    QByteArray request;
+    const ProtocolDetector *detector = nullptr;
+    int timeout = 2000;
+    int connectTimeout = 0;
+    int epollFd = -1;
+    int wakeFd = -1;
+
+    QMutex mutex;
+    QVector<Target> incoming; // guarded by mutex
+    QAtomicInt abortRequested;
+    QAtomicInt shutdownRequested;
+    QAtomicPointer<ScanStatistics::Shard> statistics;
+
+    QVector<Probe> probes;
+    QVector<int> freeSlots;
+    TimerWheel deadlines;
+    QVector<quint64> expired;
+    QElapsedTimer clock;
+};
+
+// Probe engine bypassing QNetworkAccessManager, with one epoll loop per worker
+// thread. It keeps tens of thousands of checks in flight per process. Built
+// from a protocol detector, it finds out what every port speaks instead.
+class EpollProbeEngine : public ProbeEngine
+{
+    Q_OBJECT
+
+public:
+    explicit EpollProbeEngine(const QByteArray &proxyRequest, int connectionTimeout = 2000, int tcpConnectTimeout = 0,
+                              int workerCount = QThread::idealThreadCount(), QObject *parent = nullptr);
+    explicit EpollProbeEngine(const ProtocolDetector &protocolDetector, int connectionTimeout = 2000, int tcpConnectTimeout = 0,
+                              int workerCount = QThread::idealThreadCount(), QObject *parent = nullptr);
+    ~EpollProbeEngine() override;
+
+    int getWorkerCount() const;
+    void setStatistics(ScanStatistics *statistics) override;
+
+    static QByteArray proxyRequest(const QString &scheme, const QString &url);
+
+public slots:
+    void start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout = -1) override;
+    void stop() override;
+
+private:
+    static void raiseOpenFilesLimit();
+    void startWorkers(const QByteArray &proxyRequest, int connectionTimeout, int tcpConnectTimeout, int workerCount);
+
+    QScopedPointer<const ProtocolDetector> detector;
+    QList<EpollProbeWorker*> workers;
+    int nextWorker = 0;
+};
+
+#endif // EPOLLPROBEENGINE_H
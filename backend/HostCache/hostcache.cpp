@@ -0,0 +1,150 @@
+#include "hostcache.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QDataStream>
+#include <QNetworkReply>
+
+static const quint32 CacheMagic = 0x50464843; // "PFHC"
+static const quint32 CacheVersion = 1;
+static const int MaximumEntries = 1 << 22; // new hosts aren't remembered past this, about 200 MB
+
+HostCache::HostCache()
+{
+    ttls[Live] = 24 * 3600;
+    ttls[Refused] = 6 * 3600;
+    ttls[Dead] = 3600;
+}
+
+qint64 HostCache::getTtl(Outcome outcome) const
+{
+    return ttls[outcome];
+}
+
+void HostCache::setTtl(Outcome outcome, qint64 seconds)
+{
+    ttls[outcome] = qMax(qint64(0), seconds);
+}
+
+bool HostCache::load(const QString &fileName)
+{
+    entries.clear();
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    qint32 total = 0;
+    stream >> magic >> version >> total;
+    if (magic != CacheMagic || version != CacheVersion || total < 0) {
+        return false;
+    }
+    entries.reserve(qMin(total, MaximumEntries));
+    for (qint32 i = 0; i < total && stream.status() == QDataStream::Ok; ++i) {
+        quint64 high, low;
+        Key key;
+        Entry entry;
+        stream >> high >> low >> key.port >> key.protocol >> entry.outcome >> entry.time;
+        if (entry.outcome <= Dead) {
+            key.address = IpAddress(high, low);
+            entries.insert(key, entry);
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool HostCache::save(const QString &fileName, qint64 now) const
+{
+    qint32 total = 0;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        total += isExpired(it.value(), now) ? 0 : 1;
+    }
+
+    // Written aside and renamed, so a crash never leaves a torn cache
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << CacheMagic << CacheVersion << total;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (!isExpired(it.value(), now)) {
+            const Key &key = it.key();
+            stream << key.address.high() << key.address.low() << key.port << key.protocol
+                   << it.value().outcome << it.value().time;
+        }
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void HostCache::clear()
+{
+    entries.clear();
+}
+
+int HostCache::count() const
+{
+    return entries.count();
+}
+
+void HostCache::record(const IpAddress &address, unsigned short port, int protocol, Outcome outcome, qint64 now)
+{
+    const Key key = { address, port, quint8(protocol) };
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        it->time = now;
+        it->outcome = quint8(outcome);
+    } else if (entries.count() < MaximumEntries) {
+        entries.insert(key, { now, quint8(outcome) });
+    }
+}
+
+bool HostCache::isSkipped(const IpAddress &address, unsigned short port, int protocol, qint64 now) const
+{
+    if (entries.isEmpty()) {
+        return false;
+    }
+    const auto it = entries.constFind({ address, port, quint8(protocol) });
+    return it != entries.constEnd() && it->outcome != Live && !isExpired(it.value(), now);
+}
+
+QVector<ScanTarget> HostCache::liveTargets(int protocol, qint64 now) const
+{
+    QVector<ScanTarget> targets;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (it->outcome == Live && it.key().protocol == protocol && !isExpired(it.value(), now)) {
+            targets.append({ it.key().address, it.key().port });
+        }
+    }
+    return targets;
+}
+
+bool HostCache::outcomeFromError(int error, Outcome *outcome)
+{
+    switch (error) {
+    case QNetworkReply::NoError:
+    case QNetworkReply::ProxyAuthenticationRequiredError:
+        *outcome = Live;
+        return true;
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::OperationCanceledError:
+    case QNetworkReply::ProxyNotFoundError:
+    case QNetworkReply::HostNotFoundError:
+        *outcome = Dead;
+        return true;
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::UnknownNetworkError:
+        return false;
+    default:
+        *outcome = Refused;
+        return true;
+    }
+}
+
+bool HostCache::isExpired(const Entry &entry, qint64 now) const
+{
+    return now - entry.time >= ttls[entry.outcome];
+}
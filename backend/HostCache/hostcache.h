@@ -0,0 +1,66 @@
+#ifndef HOSTCACHE_H
+#define HOSTCACHE_H
+
+#include "../IpAddress/ipaddress.h"
+#include "../TargetGenerator/targetgenerator.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Last outcome of every (address, port, protocol) checked by the previous
+// scans, kept on disk between runs. Outcomes fall in three classes, each one
+// with its own time to live: live proxies are checked first, while hosts that
+// refused or never answered are skipped until their entry expires. Lookups
+// are a single hash probe, cheap enough for every dispatched target.
+class HostCache
+{
+public:
+    enum Outcome { Live, Refused, Dead };
+
+    HostCache();
+
+    // In seconds
+    qint64 getTtl(Outcome outcome) const;
+    void setTtl(Outcome outcome, qint64 seconds);
+
+    bool load(const QString &fileName);
+    // Expired entries are dropped
+    bool save(const QString &fileName, qint64 now) const;
+    void clear();
+    int count() const;
+
+    // Times are in seconds since the epoch
+    void record(const IpAddress &address, unsigned short port, int protocol, Outcome outcome, qint64 now);
+    bool isSkipped(const IpAddress &address, unsigned short port, int protocol, qint64 now) const;
+    QVector<ScanTarget> liveTargets(int protocol, qint64 now) const;
+
+    // Returns false for the errors saying nothing about the host, like local ones
+    static bool outcomeFromError(int error, Outcome *outcome);
+
+private:
+    struct Key {
+        IpAddress address;
+        quint16 port;
+        quint8 protocol;
+
+        bool operator==(const Key &other) const
+        {
+            return address == other.address && port == other.port && protocol == other.protocol;
+        }
+        friend uint qHash(const Key &key, uint seed = 0)
+        {
+            return qHash(key.address, seed) ^ (uint(key.port) << 8 | key.protocol);
+        }
+    };
+    struct Entry {
+        qint64 time;
+        quint8 outcome;
+    };
+
+    bool isExpired(const Entry &entry, qint64 now) const;
+
+    QHash<Key, Entry> entries;
+    qint64 ttls[3];
+};
+
+#endif // HOSTCACHE_H
@@ -0,0 +1,192 @@
+#include "ipaddress.h"
+#include <limits>
+
+static const quint64 IPv4MappedLow = Q_UINT64_C(0x0000FFFF00000000);
+
+IpAddress::IpAddress() : hi(0), lo(0)
+{
+}
+
+IpAddress::IpAddress(quint64 high, quint64 low) : hi(high), lo(low)
+{
+}
+
+IpAddress IpAddress::fromIPv4(quint32 address)
+{
+    return IpAddress(0, IPv4MappedLow | address);
+}
+
+IpAddress IpAddress::fromHostAddress(const QHostAddress &address)
+{
+    bool isIPv4 = false;
+    const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+    if (isIPv4) {
+        return fromIPv4(ipv4);
+    }
+
+    const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+    quint64 high = 0, low = 0;
+    for (int i = 0; i < 8; ++i) {
+        high = (high << 8) | ipv6[i];
+        low = (low << 8) | ipv6[i + 8];
+    }
+    return IpAddress(high, low);
+}
+
+bool IpAddress::parse(const char *begin, const char *end, IpAddress *address)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+        --end;
+    }
+    if (begin == end) {
+        return false;
+    }
+
+    // Dotted quad, parsed without allocating since it's the common case
+    bool hasColon = false;
+    for (const char *c = begin; c < end; ++c) {
+        if (*c == ':') {
+            hasColon = true;
+            break;
+        }
+    }
+    if (!hasColon) {
+        quint32 result = 0;
+        int octets = 0;
+        while (begin < end && octets < 4) {
+            uint octet = 0;
+            int digits = 0;
+            while (begin < end && *begin >= '0' && *begin <= '9' && digits < 4) {
+                octet = octet * 10 + uint(*begin - '0');
+                ++begin;
+                ++digits;
+            }
+            if (digits == 0 || digits > 3 || octet > 255) {
+                return false;
+            }
+            result = (result << 8) | octet;
+            ++octets;
+            if (octets < 4) {
+                if (begin == end || *begin != '.') {
+                    return false;
+                }
+                ++begin;
+            }
+        }
+        if (octets != 4 || begin != end) {
+            return false;
+        }
+        *address = fromIPv4(result);
+        return true;
+    }
+
+    QHostAddress hostAddress;
+    if (!hostAddress.setAddress(QString::fromLatin1(begin, int(end - begin)))
+            || hostAddress.protocol() != QAbstractSocket::IPv6Protocol || !hostAddress.scopeId().isEmpty()) {
+        return false;
+    }
+    *address = fromHostAddress(hostAddress);
+    return true;
+}
+
+quint64 IpAddress::high() const
+{
+    return hi;
+}
+
+quint64 IpAddress::low() const
+{
+    return lo;
+}
+
+bool IpAddress::isIPv4() const
+{
+    return hi == 0 && (lo >> 32) == 0x0000FFFF;
+}
+
+quint32 IpAddress::toIPv4() const
+{
+    return quint32(lo);
+}
+
+QHostAddress IpAddress::toHostAddress() const
+{
+    if (isIPv4()) {
+        return QHostAddress(toIPv4());
+    }
+
+    Q_IPV6ADDR ipv6;
+    for (int i = 0; i < 8; ++i) {
+        ipv6[i] = quint8(hi >> (56 - 8 * i));
+        ipv6[i + 8] = quint8(lo >> (56 - 8 * i));
+    }
+    return QHostAddress(ipv6);
+}
+
+QString IpAddress::toString() const
+{
+    return toHostAddress().toString();
+}
+
+IpAddress IpAddress::firstInPrefix(int prefixLength) const
+{
+    const quint64 highMask = prefixLength >= 64 ? ~quint64(0) : prefixLength <= 0 ? 0 : ~quint64(0) << (64 - prefixLength);
+    const quint64 lowMask = prefixLength <= 64 ? 0 : prefixLength >= 128 ? ~quint64(0) : ~quint64(0) << (128 - prefixLength);
+    return IpAddress(hi & highMask, lo & lowMask);
+}
+
+IpAddress IpAddress::lastInPrefix(int prefixLength) const
+{
+    const quint64 highMask = prefixLength >= 64 ? ~quint64(0) : prefixLength <= 0 ? 0 : ~quint64(0) << (64 - prefixLength);
+    const quint64 lowMask = prefixLength <= 64 ? 0 : prefixLength >= 128 ? ~quint64(0) : ~quint64(0) << (128 - prefixLength);
+    return IpAddress(hi | ~highMask, lo | ~lowMask);
+}
+
+IpAddress IpAddress::next() const
+{
+    return IpAddress(lo == std::numeric_limits<quint64>::max() ? hi + 1 : hi, lo + 1);
+}
+
+IpAddress IpAddress::advanced(quint64 offset) const
+{
+    const quint64 low = lo + offset;
+    return IpAddress(low < lo ? hi + 1 : hi, low);
+}
+
+quint64 IpAddress::count(const IpAddress &last) const
+{
+    // Addresses from this one to last, both included, saturated to 64 bits
+    const quint64 maximum = std::numeric_limits<quint64>::max();
+    if (last < *this) {
+        return 0;
+    }
+    const quint64 highDifference = last.hi - hi;
+    const quint64 lowDifference = last.lo - lo;
+    if (highDifference > 1 || (highDifference == 1 && last.lo >= lo)) {
+        return maximum;
+    }
+    return lowDifference == maximum ? maximum : lowDifference + 1;
+}
+
+bool IpAddress::operator==(const IpAddress &other) const
+{
+    return hi == other.hi && lo == other.lo;
+}
+
+bool IpAddress::operator!=(const IpAddress &other) const
+{
+    return !(*this == other);
+}
+
+bool IpAddress::operator<(const IpAddress &other) const
+{
+    return hi < other.hi || (hi == other.hi && lo < other.lo);
+}
+
+bool IpAddress::operator<=(const IpAddress &other) const
+{
+    return !(other < *this);
+}
@@ -0,0 +1,52 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+#include <QHostAddress>
+#include <QMetaType>
+#include <QString>
+#include <QHashFunctions>
+
+// 128-bit address value, cheap to copy and compare. IPv4 addresses are kept
+// mapped into IPv6 (::ffff:a.b.c.d), so both families share the same ordering.
+class IpAddress
+{
+public:
+    IpAddress();
+    IpAddress(quint64 high, quint64 low);
+
+    static IpAddress fromIPv4(quint32 address);
+    static IpAddress fromHostAddress(const QHostAddress &address);
+    static bool parse(const char *begin, const char *end, IpAddress *address);
+
+    quint64 high() const;
+    quint64 low() const;
+
+    bool isIPv4() const;
+    quint32 toIPv4() const;
+    QHostAddress toHostAddress() const;
+    QString toString() const;
+
+    IpAddress firstInPrefix(int prefixLength) const;
+    IpAddress lastInPrefix(int prefixLength) const;
+    IpAddress next() const;
+    IpAddress advanced(quint64 offset) const;
+    quint64 count(const IpAddress &last) const;
+
+    bool operator==(const IpAddress &other) const;
+    bool operator!=(const IpAddress &other) const;
+    bool operator<(const IpAddress &other) const;
+    bool operator<=(const IpAddress &other) const;
+
+private:
+    quint64 hi;
+    quint64 lo;
+};
+
+inline uint qHash(const IpAddress &address, uint seed = 0)
+{
+    return qHash(qMakePair(address.high(), address.low()), seed);
+}
+
+Q_DECLARE_METATYPE(IpAddress)
+
+#endif // IPADDRESS_H
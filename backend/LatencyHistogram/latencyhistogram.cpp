@@ -0,0 +1,104 @@
+#include "latencyhistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+LatencyHistogram::Snapshot::Snapshot() : counts(Buckets, 0)
+{
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot &other)
+{
+    for (int i = 0; i < Buckets; ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    maximum = qMax(maximum, other.maximum);
+}
+
+quint64 LatencyHistogram::Snapshot::count() const
+{
+    return total;
+}
+
+double LatencyHistogram::Snapshot::mean() const
+{
+    return total ? double(sum) / double(total) : 0.0;
+}
+
+quint32 LatencyHistogram::Snapshot::max() const
+{
+    return maximum;
+}
+
+quint32 LatencyHistogram::Snapshot::percentile(double percent) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    const quint64 rank = qMax(quint64(1), quint64(std::ceil(double(total) * qBound(0.0, percent, 100.0) / 100)));
+    quint64 seen = 0;
+    for (int i = 0; i < Buckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return qMin(highestValueOf(i), maximum);
+        }
+    }
+    return maximum;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+}
+
+void LatencyHistogram::record(quint32 microseconds)
+{
+    // A single writer needs no read-modify-write
+    QAtomicInteger<quint64> &count = counts[bucketOf(microseconds)];
+    count.store(count.load() + 1);
+    sum.store(sum.load() + microseconds);
+    if (microseconds > maximum.load()) {
+        maximum.store(microseconds);
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &count : counts) {
+        count.store(0);
+    }
+    sum.store(0);
+    maximum.store(0);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot copy;
+    for (int i = 0; i < Buckets; ++i) {
+        copy.counts[i] = counts[i].load();
+        copy.total += copy.counts[i];
+    }
+    copy.sum = sum.load();
+    copy.maximum = maximum.load();
+    return copy;
+}
+
+int LatencyHistogram::bucketOf(quint32 value)
+{
+    if (value < SubBuckets) {
+        return int(value);
+    }
+    // Values sharing the highest SubBucketBits + 1 bits share the bucket
+    const int shift = 31 - qCountLeadingZeroBits(value) - SubBucketBits;
+    return (shift + 1) * SubBuckets + int((value >> shift) - SubBuckets);
+}
+
+quint32 LatencyHistogram::highestValueOf(int bucket)
+{
+    if (bucket < SubBuckets) {
+        return quint32(bucket);
+    }
+    const int shift = bucket / SubBuckets - 1;
+    const quint64 lowest = quint64(bucket % SubBuckets + SubBuckets) << shift;
+    return quint32(lowest + (quint64(1) << shift) - 1);
+}
@@ -0,0 +1,60 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QAtomicInteger>
+#include <QVector>
+
+// Latencies in microseconds, counted in log-linear buckets as HDR histograms
+// do: 32 linear buckets per power of two, so every value is known within 3%
+// up to an hour, in a fixed 7 KiB. Each histogram has a single writer, so
+// recording is a few relaxed loads and stores, without locks or shared cache
+// lines, while any thread may take a snapshot at any time.
+class LatencyHistogram
+{
+public:
+    enum { SubBucketBits = 5, SubBuckets = 1 << SubBucketBits, Buckets = (32 - SubBucketBits + 1) * SubBuckets };
+
+    // A plain copy of the counters, which adds up with the others
+    class Snapshot
+    {
+    public:
+        Snapshot();
+
+        void merge(const Snapshot &other);
+
+        quint64 count() const;
+        double mean() const;
+        quint32 max() const;
+        // Highest value of the bucket holding the percentile
+        quint32 percentile(double percent) const;
+
+    private:
+        friend class LatencyHistogram;
+
+        QVector<quint64> counts;
+        quint64 total = 0;
+        quint64 sum = 0;
+        quint32 maximum = 0;
+    };
+
+    LatencyHistogram();
+
+    // Only from the owner thread
+    void record(quint32 microseconds);
+    void reset();
+
+    // Thread safe
+    Snapshot snapshot() const;
+
+    static int bucketOf(quint32 value);
+    static quint32 highestValueOf(int bucket);
+
+private:
+    Q_DISABLE_COPY(LatencyHistogram)
+
+    QAtomicInteger<quint64> counts[Buckets];
+    QAtomicInteger<quint64> sum;
+    QAtomicInteger<quint32> maximum;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,77 @@
+#include "portset.h"
+#include <QBitArray>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+
+PortSet::PortSet()
+{
+}
+
+PortSet::PortSet(const QString &portList)
+{
+    // Marking the ports sorts them and drops the repeated ones
+    QBitArray marked(0x10000);
+    const QStringList entries = portList.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const QStringList bounds = entry.split('-');
+        bool firstOk = false, lastOk = false;
+        const uint first = bounds.first().toUInt(&firstOk);
+        const uint last = bounds.count() == 2 ? bounds.last().toUInt(&lastOk) : first;
+        if (bounds.count() == 1) {
+            lastOk = firstOk;
+        }
+        if (!firstOk || !lastOk || bounds.count() > 2 || first == 0 || last > 0xFFFF || first > last) {
+            ports.clear();
+            return;
+        }
+        marked.fill(true, int(first), int(last) + 1);
+    }
+
+    for (int port = 1; port < marked.size(); ++port) {
+        if (marked.testBit(port)) {
+            ports.append(static_cast<unsigned short>(port));
+        }
+    }
+    valid = !ports.isEmpty();
+}
+
+bool PortSet::isValid() const
+{
+    return valid;
+}
+
+bool PortSet::isEmpty() const
+{
+    return ports.isEmpty();
+}
+
+int PortSet::count() const
+{
+    return ports.count();
+}
+
+unsigned short PortSet::at(int index) const
+{
+    return ports.at(index);
+}
+
+bool PortSet::contains(unsigned short port) const
+{
+    return std::binary_search(ports.constBegin(), ports.constEnd(), port);
+}
+
+QString PortSet::toString() const
+{
+    // Consecutive ports are written back as ranges
+    QStringList entries;
+    for (int i = 0; i < ports.count(); ++i) {
+        int j = i;
+        while (j + 1 < ports.count() && ports[j + 1] == ports[j] + 1) {
+            ++j;
+        }
+        entries.append(i == j ? QString::number(ports[i]) : QString::number(ports[i]) + '-' + QString::number(ports[j]));
+        i = j;
+    }
+    return entries.join(',');
+}
@@ -0,0 +1,27 @@
+#ifndef PORTSET_H
+#define PORTSET_H
+
+#include <QString>
+#include <QVector>
+
+// Sorted set of ports written as a list of ports and ranges, like "80,3128,8000-8100"
+class PortSet
+{
+public:
+    PortSet();
+    explicit PortSet(const QString &portList);
+
+    bool isValid() const;
+    bool isEmpty() const;
+    int count() const;
+    unsigned short at(int index) const;
+    bool contains(unsigned short port) const;
+
+    QString toString() const;
+
+private:
+    QVector<unsigned short> ports;
+    bool valid = false;
+};
+
+#endif // PORTSET_H
@@ -0,0 +1,16 @@
+#include "probeengine.h"
+
+ProbeEngine::ProbeEngine(QObject *parent) : QObject(parent)
+{
+    // Replies cross threads, so the address must be known to queued connections
+    qRegisterMetaType<IpAddress>();
+}
+
+ProbeEngine::~ProbeEngine()
+{
+}
+
+void ProbeEngine::setStatistics(ScanStatistics *statistics)
+{
+    Q_UNUSED(statistics)
+}
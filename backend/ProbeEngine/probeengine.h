@@ -0,0 +1,37 @@
+#ifndef PROBEENGINE_H
+#define PROBEENGINE_H
+
+#include "../IpAddress/ipaddress.h"
+#include <QObject>
+
+class ScanStatistics;
+
+// Common interface of the engines able to check proxies. Every started check
+// is answered with exactly one replied() signal, whose error is a
+// QNetworkReply::NetworkError code. Checks failing on the local side, out of
+// sockets or ports, are answered with TemporaryNetworkFailureError. Every check
+// may have its own timeout, or -1 for the one the engine was created with.
+// Engines detecting protocols also answer the ProtocolDetector::Protocol
+// flags found, 0 otherwise. Stopping answers the checks still in flight with
+// OperationCanceledError.
+class ProbeEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProbeEngine(QObject *parent = nullptr);
+    ~ProbeEngine() override;
+
+    // Engines able to time the stages of the checks record them in shards of
+    // the statistics, one per worker thread. Set before the first check.
+    virtual void setStatistics(ScanStatistics *statistics);
+
+signals:
+    void replied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols);
+
+public slots:
+    virtual void start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout = -1) = 0;
+    virtual void stop() = 0;
+};
+
+#endif // PROBEENGINE_H
@@ -0,0 +1,275 @@
+#include "protocoldetector.h"
+#include <QHostAddress>
+#include <QNetworkReply>
+#include <QStringList>
+#include <QUrl>
+#include <string.h>
+
+static bool isHttpStatusLine(const char *data, int size, int *statusCode)
+{
+    // HTTP/1.x <code> <reason phrase>
+    const QByteArray line = QByteArray::fromRawData(data, size);
+    const int firstSpace = line.indexOf(' ');
+    bool ok = false;
+    *statusCode = firstSpace < 0 ? 0 : line.mid(firstSpace + 1, 3).toInt(&ok);
+    return line.startsWith("HTTP/") && ok;
+}
+
+ProtocolDetector::ProtocolDetector(const QString &url)
+{
+    const QUrl target("http://" + url);
+    const QByteArray host = target.host(QUrl::FullyEncoded).toLatin1();
+    const quint16 port = quint16(target.port(80));
+    const QByteArray portBytes = QByteArray(1, char(port >> 8)) + char(port & 0xFF);
+    bool isIPv4 = false;
+    const quint32 ipv4 = QHostAddress(QString::fromLatin1(host)).toIPv4Address(&isIPv4);
+    const QByteArray ipv4Bytes = QByteArray(1, char(ipv4 >> 24)) + char(ipv4 >> 16) + char(ipv4 >> 8) + char(ipv4);
+
+    // Methods: no authentication, username/password and four unassigned ones
+    requests[Socks5Greeting] = QByteArray("\x05\x06\x00\x02\r\n\r\n", 8);
+
+    requests[Socks5Connect] = QByteArray("\x05\x01\x00", 3);
+    if (isIPv4) {
+        requests[Socks5Connect] += '\x01' + ipv4Bytes;
+    } else {
+        requests[Socks5Connect] += '\x03' + QByteArray(1, char(qMin(host.size(), 255))) + host.left(255);
+    }
+    requests[Socks5Connect] += portBytes;
+
+    // SOCKS4a when the host is a name: an invalid address followed by the name
+    requests[Socks4Request] = QByteArray("\x04\x01", 2) + portBytes;
+    if (isIPv4) {
+        requests[Socks4Request] += ipv4Bytes + '\0';
+    } else {
+        requests[Socks4Request] += QByteArray("\x00\x00\x00\x01\x00", 5) + host + '\0';
+    }
+
+    QByteArray absoluteUri = target.toEncoded(QUrl::RemoveFragment);
+    if (target.path().isEmpty()) {
+        absoluteUri += '/';
+    }
+    requests[HttpGet] = "GET " + absoluteUri + " HTTP/1.1\r\n"
+                        "Host: " + host + "\r\n"
+                        "User-Agent: Requester\r\n"
+                        "Connection: close\r\n\r\n";
+
+    const QByteArray authority = host + ":443";
+    requests[HttpConnectRequest] = "CONNECT " + authority + " HTTP/1.1\r\n"
+                                   "Host: " + authority + "\r\n"
+                                   "User-Agent: Requester\r\n\r\n";
+}
+
+const QByteArray &ProtocolDetector::request(int stage) const
+{
+    return requests[qBound(0, stage, Done - 1)];
+}
+
+bool ProtocolDetector::isComplete(int stage, const char *data, int size) const
+{
+    switch (stage) {
+    case Socks5Greeting:
+        // Either the chosen method or the status line of an HTTP error
+        if (size > 0 && data[0] == '\x05') {
+            return size >= 2;
+        }
+        return memchr(data, '\n', size_t(size)) != nullptr;
+    case Socks5Connect:
+    case Socks4Request:
+        // Only the status is needed, not the bound address
+        return size >= 2;
+    default:
+        return memchr(data, '\n', size_t(size)) != nullptr;
+    }
+}
+
+ProtocolDetector::Action ProtocolDetector::onAnswer(State &state, const char *data, int size) const
+{
+    int statusCode = 0;
+    switch (state.stage) {
+    case Socks5Greeting:
+        if (size >= 2 && data[0] == '\x05') {
+            state.protocols |= Socks5;
+            switch (quint8(data[1])) {
+            case 0x00:
+                state.stage = Socks5Connect;
+                return SendOnSameConnection;
+            case 0x02:
+            case 0xFF:
+                state.error = QNetworkReply::ProxyAuthenticationRequiredError;
+                break;
+            default:
+                state.error = QNetworkReply::ProtocolFailure;
+            }
+            state.stage = Done;
+            return Finish;
+        }
+        if (isHttpStatusLine(data, size, &statusCode)) {
+            state.spokeHttp = true;
+            return next(state, HttpGet);
+        }
+        return onClosed(state);
+
+    case Socks5Connect:
+        if (size >= 2 && data[0] == '\x05') {
+            switch (quint8(data[1])) {
+            case 0x00:
+                state.working |= Socks5;
+                state.error = QNetworkReply::NoError;
+                break;
+            case 0x02:
+                state.error = QNetworkReply::ContentAccessDenied;
+                break;
+            case 0x03:
+            case 0x04:
+                state.error = QNetworkReply::HostNotFoundError;
+                break;
+            case 0x05:
+                state.error = QNetworkReply::ConnectionRefusedError;
+                break;
+            case 0x06:
+                state.error = QNetworkReply::TimeoutError;
+                break;
+            default:
+                state.error = QNetworkReply::UnknownProxyError;
+            }
+        } else {
+            state.error = QNetworkReply::ProtocolFailure;
+        }
+        state.stage = Done;
+        return Finish;
+
+    case Socks4Request:
+        if (size >= 2 && data[0] == '\0' && quint8(data[1]) >= 0x5A && quint8(data[1]) <= 0x5D) {
+            state.protocols |= Socks4;
+            switch (quint8(data[1])) {
+            case 0x5A:
+                state.working |= Socks4;
+                state.error = QNetworkReply::NoError;
+                break;
+            case 0x5B:
+                state.error = QNetworkReply::ProxyConnectionRefusedError;
+                break;
+            default:
+                // The identd checks
+                state.error = QNetworkReply::ProxyAuthenticationRequiredError;
+            }
+            state.stage = Done;
+            return Finish;
+        }
+        return onClosed(state);
+
+    case HttpGet:
+    case HttpConnectRequest:
+        if (!isHttpStatusLine(data, size, &statusCode)) {
+            return onClosed(state);
+        }
+        state.spokeHttp = true;
+        if (state.stage == HttpGet) {
+            state.protocols |= HttpForward;
+            state.error = errorFromStatusCode(statusCode);
+            if (state.error == QNetworkReply::NoError) {
+                state.working |= HttpForward;
+            }
+            return next(state, HttpConnectRequest);
+        }
+        state.protocols |= HttpConnect;
+        if (statusCode >= 200 && statusCode < 300) {
+            state.working |= HttpConnect;
+        }
+        // The forward check tells more about the proxy than the tunnel
+        if (!(state.protocols & HttpForward)) {
+            state.error = errorFromStatusCode(statusCode);
+        }
+        state.stage = Done;
+        return Finish;
+
+    default:
+        return Finish;
+    }
+}
+
+ProtocolDetector::Action ProtocolDetector::onClosed(State &state) const
+{
+    switch (state.stage) {
+    case Socks5Greeting:
+        return next(state, Socks4Request);
+    case Socks4Request:
+        return next(state, HttpGet);
+    case HttpGet:
+        return next(state, HttpConnectRequest);
+    case Socks5Connect:
+        state.error = QNetworkReply::ProxyConnectionClosedError;
+        break;
+    default:
+        if (state.protocols == 0) {
+            state.error = state.spokeHttp ? QNetworkReply::ProtocolFailure : QNetworkReply::ProxyConnectionClosedError;
+        }
+    }
+    state.stage = Done;
+    return Finish;
+}
+
+int ProtocolDetector::error(const State &state, QString *reason)
+{
+    if (state.working) {
+        *reason = protocolNames(state.working);
+        return QNetworkReply::NoError;
+    }
+    if (state.protocols) {
+        *reason = protocolNames(state.protocols);
+        return state.error;
+    }
+    switch (state.error) {
+    case QNetworkReply::ProxyConnectionClosedError:
+        *reason = QStringLiteral("Proxy connection closed prematurely");
+        break;
+    default:
+        *reason = QStringLiteral("Unknown protocol");
+    }
+    return state.error == QNetworkReply::NoError ? int(QNetworkReply::ProtocolFailure) : state.error;
+}
+
+QString ProtocolDetector::protocolNames(int protocols)
+{
+    QStringList names;
+    if (protocols & HttpForward) {
+        names << QStringLiteral("HTTP");
+    }
+    if (protocols & HttpConnect) {
+        names << QStringLiteral("CONNECT");
+    }
+    if (protocols & Socks4) {
+        names << QStringLiteral("SOCKS4");
+    }
+    if (protocols & Socks5) {
+        names << QStringLiteral("SOCKS5");
+    }
+    return names.join(", ");
+}
+
+int ProtocolDetector::errorFromStatusCode(int statusCode)
+{
+    if (statusCode >= 200 && statusCode < 400) {
+        return QNetworkReply::NoError;
+    }
+    switch (statusCode) {
+    case 401: return QNetworkReply::AuthenticationRequiredError;
+    case 403: return QNetworkReply::ContentAccessDenied;
+    case 404: return QNetworkReply::ContentNotFoundError;
+    case 405: return QNetworkReply::ContentOperationNotPermittedError;
+    case 407: return QNetworkReply::ProxyAuthenticationRequiredError;
+    case 409: return QNetworkReply::ContentConflictError;
+    case 410: return QNetworkReply::ContentGoneError;
+    case 500: return QNetworkReply::InternalServerError;
+    case 501: return QNetworkReply::OperationNotImplementedError;
+    case 503: return QNetworkReply::ServiceUnavailableError;
+    default:
+        return statusCode >= 500 ? QNetworkReply::UnknownServerError : QNetworkReply::UnknownContentError;
+    }
+}
+
+ProtocolDetector::Action ProtocolDetector::next(State &state, int stage) const
+{
+    state.stage = quint8(stage);
+    return Reconnect;
+}
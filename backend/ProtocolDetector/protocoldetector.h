@@ -0,0 +1,55 @@
+#ifndef PROTOCOLDETECTOR_H
+#define PROTOCOLDETECTOR_H
+
+#include <QByteArray>
+#include <QString>
+
+// Finds out which proxy protocols an open port speaks, from the first bytes
+// of its answers. Only the exchange is described here, the connections belong
+// to the engine. Every check goes through a few stages:
+//  1. A SOCKS5 greeting whose method list ends in "\r\n\r\n". SOCKS5 servers
+//     answer the method they pick and the CONNECT goes on the same connection,
+//     while HTTP proxies read a whole malformed request and answer an error.
+//  2. Hosts answering HTTP are checked with a forward GET and a CONNECT.
+//  3. Hosts closing the connection are asked a SOCKS4a CONNECT, and then
+//     both HTTP requests, since some HTTP proxies drop garbage silently.
+class ProtocolDetector
+{
+public:
+    enum Protocol { HttpForward = 0x1, HttpConnect = 0x2, Socks4 = 0x4, Socks5 = 0x8 };
+    enum Stage { Socks5Greeting, Socks5Connect, Socks4Request, HttpGet, HttpConnectRequest, Done };
+
+    // Progress of one check, small enough to live in the probe
+    struct State {
+        quint8 stage = Socks5Greeting;
+        quint8 protocols = 0; // detected, working or not
+        quint8 working = 0;
+        bool spokeHttp = false;
+        int error = 0; // of the last protocol detected
+    };
+
+    // What the engine does next
+    enum Action { SendOnSameConnection, Reconnect, Finish };
+
+    explicit ProtocolDetector(const QString &url);
+
+    const QByteArray &request(int stage) const;
+    // Whether the answer is long enough to be judged
+    bool isComplete(int stage, const char *data, int size) const;
+    Action onAnswer(State &state, const char *data, int size) const;
+    // Closed, reset or garbled before a complete answer
+    Action onClosed(State &state) const;
+
+    // Error and reason of the finished check, NoError if any protocol works
+    static int error(const State &state, QString *reason);
+    static QString protocolNames(int protocols);
+    // Maps the status code answered by an HTTP proxy to the error QNetworkAccessManager would report
+    static int errorFromStatusCode(int statusCode);
+
+private:
+    Action next(State &state, int stage) const;
+
+    QByteArray requests[Done];
+};
+
+#endif // PROTOCOLDETECTOR_H
@@ -0,0 +1,316 @@
+#include "proxybenchmark.h"
+#include <QRegularExpression>
+#include <algorithm>
+#include <limits>
+
+// Downloads are cut there, enough for a steady throughput
+static const qint64 MaximumDownload = 1 << 20;
+static const int MaximumJudgeBody = 64 * 1024;
+
+static quint32 percentile(QVector<quint32> values, int percent)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    const int index = (values.count() * percent + 99) / 100 - 1;
+    return values[qBound(0, index, values.count() - 1)];
+}
+
+ProxyBenchmark::ProxyBenchmark(const QUrl &url, const QUrl &judgeUrl, int samples, int timeout, QObject *parent)
+    : QNetworkAccessManager(parent), benchmarkUrl(url), judge(judgeUrl), samples(qBound(1, samples, 255)), timeout(timeout)
+{
+    clock.start();
+
+    // Our address as the judge sees it, to find it in what the proxies forward
+    if (judge.isValid()) {
+        setProxy(QNetworkProxy::NoProxy);
+        QNetworkReply *reply = get(QNetworkRequest(judge));
+        connect(reply, &QNetworkReply::finished, this, [=] {
+            if (reply->error() == QNetworkReply::NoError) {
+                ownAddresses = addressesIn(reply->read(MaximumJudgeBody));
+            }
+            reply->deleteLater();
+        });
+    }
+}
+
+void ProxyBenchmark::start(quint64 sequence, const ScanResult &result, QNetworkProxy::ProxyType type)
+{
+    int slot;
+    if (freeRuns.isEmpty()) {
+        slot = runs.count();
+        runs.append(Run());
+        QTimer *timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [=] {
+            onTimeout(slot);
+        });
+        runs[slot].timer = timer;
+        runs[slot].manager = new QNetworkAccessManager(this);
+    } else {
+        slot = freeRuns.takeLast();
+    }
+
+    Run &r = runs[slot];
+    r.sequence = sequence;
+    r.result = result;
+    r.type = type;
+    r.sample = 0;
+    r.body.clear();
+    r.connectTimes.clear();
+    r.firstByteTimes.clear();
+    r.throughputs.clear();
+    r.active = true;
+    running++;
+    startSample(slot);
+}
+
+void ProxyBenchmark::stop()
+{
+    for (int slot = 0; slot < runs.count(); ++slot) {
+        Run &r = runs[slot];
+        if (r.active) {
+            r.timer->stop();
+            dropSocket(slot);
+            dropReply(slot);
+            r.active = false;
+            freeRuns.append(slot);
+        }
+    }
+    running = 0;
+}
+
+int ProxyBenchmark::count() const
+{
+    return running;
+}
+
+QString ProxyBenchmark::anonymityName(int anonymity)
+{
+    switch (anonymity) {
+    case Transparent: return QStringLiteral("transparent");
+    case Anonymous: return QStringLiteral("anonymous");
+    case Elite: return QStringLiteral("elite");
+    default: return QString();
+    }
+}
+
+void ProxyBenchmark::startSample(int slot)
+{
+    Run &r = runs[slot];
+    if (r.sample >= samples) {
+        startJudge(slot);
+        return;
+    }
+
+    // The connection alone, without anything the proxy does afterwards
+    r.phase = Connecting;
+    QTcpSocket *socket = new QTcpSocket(this);
+    socket->setProxy(QNetworkProxy::NoProxy);
+    r.socket = socket;
+    connect(socket, &QTcpSocket::connected, this, [=] {
+        Run &run = runs[slot];
+        run.connectTimes.append(quint32((clock.nsecsElapsed() - run.startedAt) / 1000));
+        dropSocket(slot);
+        startDownload(slot);
+    });
+    connect(socket, &QAbstractSocket::errorOccurred, this, [=] {
+        dropSocket(slot);
+        runs[slot].sample++;
+        startSample(slot);
+    });
+    r.startedAt = clock.nsecsElapsed();
+    socket->connectToHost(r.result.address.toHostAddress(), r.result.port);
+    r.timer->start(timeout);
+}
+
+void ProxyBenchmark::startDownload(int slot)
+{
+    Run &r = runs[slot];
+    r.phase = Downloading;
+    r.firstByteAt = -1;
+    r.bytes = 0;
+    r.startedAt = clock.nsecsElapsed();
+    r.reply = request(slot, benchmarkUrl);
+    // Long enough for the whole download on a slow proxy
+    r.timer->start(timeout * 4);
+}
+
+void ProxyBenchmark::startJudge(int slot)
+{
+    Run &r = runs[slot];
+    if (!judge.isValid()) {
+        finish(slot);
+        return;
+    }
+    r.phase = Judging;
+    r.body.clear();
+    r.reply = request(slot, judge);
+    r.timer->start(timeout * 2);
+}
+
+QNetworkReply *ProxyBenchmark::request(int slot, const QUrl &target)
+{
+    const Run &r = runs[slot];
+    // Never switched while a reply of the slot runs, as in ProxyChecker
+    r.manager->setProxy(QNetworkProxy(r.type, r.result.address.toString(), r.result.port));
+
+    QNetworkRequest networkRequest(target);
+    networkRequest.setHeader(QNetworkRequest::UserAgentHeader, "Requester");
+    networkRequest.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    QNetworkReply *reply = r.manager->get(networkRequest);
+    connect(reply, &QNetworkReply::metaDataChanged, this, [=] {
+        Run &run = runs[slot];
+        if (run.firstByteAt < 0) {
+            run.firstByteAt = clock.nsecsElapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::readyRead, this, [=] {
+        onReadyRead(slot);
+    });
+    connect(reply, &QNetworkReply::finished, this, [=] {
+        onReplyFinished(slot);
+    });
+    return reply;
+}
+
+void ProxyBenchmark::onReadyRead(int slot)
+{
+    Run &r = runs[slot];
+    const QByteArray data = r.reply->readAll();
+    if (r.firstByteAt < 0) {
+        r.firstByteAt = clock.nsecsElapsed();
+    }
+
+    if (r.phase == Judging) {
+        r.body += data.left(MaximumJudgeBody - r.body.size());
+        return;
+    }
+    r.bytes += data.size();
+    if (r.bytes >= MaximumDownload) {
+        onTimeout(slot);
+    }
+}
+
+void ProxyBenchmark::onReplyFinished(int slot)
+{
+    Run &r = runs[slot];
+    r.timer->stop();
+    const QNetworkReply::NetworkError error = r.reply->error();
+    if (r.phase == Judging) {
+        r.body += r.reply->readAll().left(MaximumJudgeBody - r.body.size());
+        dropReply(slot);
+        r.result.benchmark.anonymity = quint8(error == QNetworkReply::NoError ? anonymityOf(r.body) : int(UnknownAnonymity));
+        finish(slot);
+        return;
+    }
+
+    r.bytes += r.reply->readAll().size();
+    if (error == QNetworkReply::NoError) {
+        onTimeout(slot);
+        return;
+    }
+    dropReply(slot);
+    r.sample++;
+    startSample(slot);
+}
+
+void ProxyBenchmark::onTimeout(int slot)
+{
+    Run &r = runs[slot];
+    r.timer->stop();
+    switch (r.phase) {
+    case Connecting:
+        dropSocket(slot);
+        break;
+    case Downloading:
+        // Also reached once the download is over, or long enough
+        if (r.firstByteAt >= 0) {
+            const qint64 now = clock.nsecsElapsed();
+            r.firstByteTimes.append(quint32((r.firstByteAt - r.startedAt) / 1000));
+            if (r.bytes > 0 && now > r.firstByteAt) {
+                const qint64 rate = r.bytes * 1000000000 / (now - r.firstByteAt);
+                r.throughputs.append(quint32(qMin(rate, qint64(std::numeric_limits<quint32>::max()))));
+            }
+        }
+        dropReply(slot);
+        break;
+    case Judging:
+        dropReply(slot);
+        finish(slot);
+        return;
+    }
+    r.sample++;
+    startSample(slot);
+}
+
+void ProxyBenchmark::dropSocket(int slot)
+{
+    Run &r = runs[slot];
+    if (r.socket) {
+        r.socket->disconnect(this);
+        r.socket->abort();
+        r.socket->deleteLater();
+        r.socket = nullptr;
+    }
+}
+
+void ProxyBenchmark::dropReply(int slot)
+{
+    Run &r = runs[slot];
+    if (r.reply) {
+        r.reply->disconnect(this);
+        r.reply->abort();
+        r.reply->deleteLater();
+        r.reply = nullptr;
+    }
+}
+
+void ProxyBenchmark::finish(int slot)
+{
+    Run &r = runs[slot];
+    BenchmarkResult &benchmark = r.result.benchmark;
+    benchmark.samples = quint8(r.firstByteTimes.count());
+    benchmark.connectTime = percentile(r.connectTimes, 50);
+    benchmark.firstByteTime = percentile(r.firstByteTimes, 50);
+    benchmark.firstByteTime90 = percentile(r.firstByteTimes, 90);
+    benchmark.throughput = percentile(r.throughputs, 50);
+
+    r.timer->stop();
+    r.active = false;
+    const quint64 sequence = r.sequence;
+    const ScanResult result = r.result;
+    freeRuns.append(slot);
+    running--;
+    emit finished(sequence, result);
+}
+
+int ProxyBenchmark::anonymityOf(const QByteArray &body) const
+{
+    // Without our own address, transparent proxies pass for anonymous ones
+    for (const QByteArray &address : addressesIn(body)) {
+        if (ownAddresses.contains(address)) {
+            return Transparent;
+        }
+    }
+    // Headers added by proxies, as the judges print them: Via: ..., HTTP_VIA = ..., "Via": ...
+    static const QRegularExpression proxyHeaders("(^|[^a-z])(http_)?(via|x[-_]forwarded[-_]for|forwarded|x[-_]real[-_]ip|"
+                                                 "proxy[-_]connection|client[-_]ip)[\"']?\\s*[:=]",
+                                                 QRegularExpression::CaseInsensitiveOption);
+    if (proxyHeaders.match(QString::fromLatin1(body)).hasMatch()) {
+        return Anonymous;
+    }
+    return Elite;
+}
+
+QSet<QByteArray> ProxyBenchmark::addressesIn(const QByteArray &body)
+{
+    static const QRegularExpression ipv4("(?<![\\d.])\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}(?![\\d.])");
+    QSet<QByteArray> addresses;
+    auto it = ipv4.globalMatch(QString::fromLatin1(body));
+    while (it.hasNext()) {
+        addresses.insert(it.next().captured(0).toLatin1());
+    }
+    return addresses;
+}
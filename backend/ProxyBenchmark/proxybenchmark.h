@@ -0,0 +1,88 @@
+#ifndef PROXYBENCHMARK_H
+#define PROXYBENCHMARK_H
+
+#include "../ScanResult/scanresult.h"
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include <QNetworkReply>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QSet>
+#include <QUrl>
+
+// Measures the proxies found, one after the other check of the scan. Every
+// proxy is sampled a few times: a plain TCP connection to it, then a download
+// of the request URL through it, for the time to first byte and the
+// throughput. A last request to the judge URL, a page echoing the request
+// headers, tells whether the proxy reveals our address or itself. Samples
+// failing are left out, so a proxy may end up with fewer or none.
+class ProxyBenchmark : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    enum Anonymity { UnknownAnonymity, Transparent, Anonymous, Elite };
+
+    explicit ProxyBenchmark(const QUrl &url, const QUrl &judgeUrl, int samples = 3, int timeout = 2000, QObject *parent = nullptr);
+
+    void start(quint64 sequence, const ScanResult &result, QNetworkProxy::ProxyType type);
+    void stop();
+    int count() const;
+
+    static QString anonymityName(int anonymity);
+
+signals:
+    // The result carries the benchmark
+    void finished(quint64 sequence, const ScanResult &result);
+
+private:
+    enum Phase { Connecting, Downloading, Judging };
+
+    struct Run {
+        quint64 sequence = 0;
+        ScanResult result;
+        QNetworkProxy::ProxyType type = QNetworkProxy::HttpProxy;
+        Phase phase = Connecting;
+        int sample = 0;
+        QNetworkAccessManager *manager = nullptr; // of the slot, through the proxy measured
+        QTcpSocket *socket = nullptr;
+        QNetworkReply *reply = nullptr;
+        QTimer *timer = nullptr;
+        qint64 startedAt = 0;
+        qint64 firstByteAt = -1;
+        qint64 bytes = 0;
+        QByteArray body;
+        QVector<quint32> connectTimes;
+        QVector<quint32> firstByteTimes;
+        QVector<quint32> throughputs;
+        bool active = false;
+    };
+
+    void startSample(int slot);
+    void startDownload(int slot);
+    void startJudge(int slot);
+    QNetworkReply *request(int slot, const QUrl &target);
+    void onReadyRead(int slot);
+    void onReplyFinished(int slot);
+    void onTimeout(int slot);
+    void dropSocket(int slot);
+    void dropReply(int slot);
+    void finish(int slot);
+    int anonymityOf(const QByteArray &body) const;
+    static QSet<QByteArray> addressesIn(const QByteArray &body);
+
+    QUrl benchmarkUrl;
+    QUrl judge;
+    int samples = 3;
+    int timeout = 2000;
+    QSet<QByteArray> ownAddresses; // as the judge sees them without a proxy
+
+    QVector<Run> runs;
+    QVector<int> freeRuns;
+    int running = 0;
+    QElapsedTimer clock;
+};
+
+#endif // PROXYBENCHMARK_H
@@ -2,40 +2,220 @@
 #include <QDebug>
 #include <QEventLoop>
 
-ProxyChecker::ProxyChecker(const QNetworkProxy &proxy, int connectionTimeout, QObject *parent) : QNetworkAccessManager(parent)
+// Attribute used to carry the check slot along with its reply
+static const QNetworkRequest::Attribute CheckAttribute = QNetworkRequest::User;
+
+ProxyChecker::ProxyChecker(const QNetworkRequest &request, QNetworkProxy::ProxyType type,
+                           int connectionTimeout, int tcpConnectTimeout, QObject *parent) : QObject(parent)
 {
-    setProxy(proxy);
+    networkRequest = request;
+    proxyType = type;
     timeout = connectionTimeout;
+    connectTimeout = tcpConnectTimeout;
     if (timeout < 100) {
         qWarning() << "ProxyChecker: The configured network timeout is less than 100 ms";
     }
+    // The only timer of the worker, armed for the next deadline of the wheel.
+    // Parented, so it moves to the worker thread along with the checker
+    tick.setParent(this);
+    tick.setSingleShot(true);
+    tick.setTimerType(Qt::PreciseTimer);
+    connect(&tick, &QTimer::timeout, this, &ProxyChecker::onTick);
+    clock.start();
+}
+
+int ProxyChecker::getTimeout() const
+{
+    return timeout;
 }
 
-QString ProxyChecker::getHostName() const
+int ProxyChecker::getConnectTimeout() const
 {
-    return proxy().hostName();
+    return connectTimeout;
 }
 
-unsigned short ProxyChecker::getPort() const
+void ProxyChecker::setStatistics(ScanStatistics::Shard *shard)
 {
-    return proxy().port();
+    statistics = shard;
 }
 
-void ProxyChecker::start(const QNetworkRequest &request)
+int ProxyChecker::errorFromSocketError(QAbstractSocket::SocketError socketError)
 {
-    QNetworkReply *reply = get(request);
+    switch (socketError) {
+    case QAbstractSocket::ConnectionRefusedError:
+        return QNetworkReply::ProxyConnectionRefusedError;
+    case QAbstractSocket::RemoteHostClosedError:
+        return QNetworkReply::ProxyConnectionClosedError;
+    case QAbstractSocket::HostNotFoundError:
+    case QAbstractSocket::NetworkError:
+        return QNetworkReply::ProxyNotFoundError;
+    case QAbstractSocket::SocketTimeoutError:
+        return QNetworkReply::ProxyTimeoutError;
+    case QAbstractSocket::SocketResourceError:
+    case QAbstractSocket::SocketAddressNotAvailableError:
+        return QNetworkReply::TemporaryNetworkFailureError;
+    default:
+        return QNetworkReply::UnknownNetworkError;
+    }
+}
+
+void ProxyChecker::start(quint64 sequence, const IpAddress &address, unsigned short port, int checkTimeout)
+{
+    if (checkTimeout <= 0) {
+        checkTimeout = timeout;
+    }
+
+    int slot;
+    if (freeChecks.isEmpty()) {
+        slot = checks.count();
+        checks.append(Check());
+    } else {
+        slot = freeChecks.takeLast();
+    }
+    Check &c = checks[slot];
+    c.sequence = sequence;
+    c.address = address;
+    c.port = port;
+    c.timeout = checkTimeout;
 
-    QTimer *t = new QTimer;
-    t->setSingleShot(true);
+    if (connectTimeout <= 0) {
+        check(slot);
+        return;
+    }
+
+    // First stage: a plain TCP connection with its own, shorter, timeout
+    QTcpSocket *socket = new QTcpSocket(this);
+    socket->setProxy(QNetworkProxy::NoProxy);
+    c.socket = socket;
 
-    connect(t, &QTimer::timeout, reply, &QNetworkReply::abort);
-    connect(t, &QTimer::timeout, t, &QTimer::deleteLater);
-    connect(reply, &QNetworkReply::finished, t, &QTimer::stop);
+    connect(socket, &QTcpSocket::connected, this, [=] {
+        if (statistics) {
+            statistics->connectTime.record(quint32((clock.nsecsElapsed() - checks[slot].stageStartedAt) / 1000));
+        }
+        finishConnect(slot);
+        check(slot);
+    });
+    connect(socket, &QAbstractSocket::errorOccurred, this, [=](QAbstractSocket::SocketError socketError) {
+        const QString reason = socket->errorString();
+        finishConnect(slot);
+        finish(slot, errorFromSocketError(socketError), reason);
+    });
 
-    t->start(timeout);
+    c.stageStartedAt = clock.nsecsElapsed();
+    socket->connectToHost(address.toHostAddress(), port);
+    arm(slot, qMin(connectTimeout, checkTimeout));
+}
+
+void ProxyChecker::check(int slot)
+{
+    Check &c = checks[slot];
+
+    // Some backends only read the proxy of the manager once the operation starts,
+    // later in the event loop, so it's never switched while a reply is running
+    if (!c.manager) {
+        c.manager = new QNetworkAccessManager(this);
+        connect(c.manager, &QNetworkAccessManager::finished, this, &ProxyChecker::onFinished);
+    }
+    c.manager->setProxy(QNetworkProxy(proxyType, c.address.toString(), c.port));
+
+    QNetworkRequest request(networkRequest);
+    request.setAttribute(CheckAttribute, slot);
+    c.stageStartedAt = clock.nsecsElapsed();
+    QNetworkReply *reply = c.manager->get(request);
+    c.reply = reply;
+    if (statistics) {
+        // Without the sweep, the connection to the proxy is part of it
+        connect(reply, &QNetworkReply::metaDataChanged, this, [=] {
+            if (checks[slot].reply == reply && checks[slot].stageStartedAt >= 0) {
+                statistics->firstByteTime.record(quint32((clock.nsecsElapsed() - checks[slot].stageStartedAt) / 1000));
+                checks[slot].stageStartedAt = -1;
+            }
+        });
+    }
+    arm(slot, c.timeout);
 }
 
 void ProxyChecker::stop()
 {
+    // Every check in flight is still answered, as cancelled
+    for (int slot = 0; slot < checks.count(); ++slot) {
+        if (checks[slot].socket) {
+            finishConnect(slot);
+            finish(slot, QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+        } else if (checks[slot].reply) {
+            // Answered through onFinished
+            checks[slot].reply->abort();
+        }
+    }
+}
+
+void ProxyChecker::onFinished(QNetworkReply *reply)
+{
+    const int slot = reply->request().attribute(CheckAttribute).toInt();
+    finish(slot, reply->error(), reply->errorString());
+    reply->deleteLater();
+}
+
+void ProxyChecker::onTick()
+{
+    expired.clear();
+    deadlines.advance(clock.elapsed(), expired);
+    for (quint64 data : expired) {
+        const int slot = int(data);
+        Check &c = checks[slot];
+        c.timer = 0;
+        if (c.socket) {
+            finishConnect(slot);
+            finish(slot, QNetworkReply::ProxyTimeoutError, QStringLiteral("Proxy server connection timed out"));
+        } else if (c.reply) {
+            // Answered through onFinished
+            c.reply->abort();
+        }
+    }
+    schedule();
+}
+
+void ProxyChecker::arm(int slot, int checkTimeout)
+{
+    const qint64 deadline = clock.elapsed() + checkTimeout;
+    checks[slot].timer = deadlines.start(deadline, quint64(slot));
+    // Only moved when the new deadline comes before the one waited for
+    if (!tick.isActive() || deadline < tickDeadline) {
+        schedule();
+    }
+}
+
+void ProxyChecker::schedule()
+{
+    tickDeadline = deadlines.nextExpiry();
+    if (tickDeadline < 0) {
+        tick.stop();
+        return;
+    }
+    tick.start(int(qMax<qint64>(0, tickDeadline - clock.elapsed())));
+}
 
+void ProxyChecker::finishConnect(int slot)
+{
+    QTcpSocket *socket = checks[slot].socket;
+    checks[slot].socket = nullptr;
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+}
+
+void ProxyChecker::finish(int slot, int error, const QString &reason)
+{
+    const Check c = checks[slot];
+    release(slot);
+    emit replied(c.sequence, c.address, c.port, error, reason, 0);
+}
+
+void ProxyChecker::release(int slot)
+{
+    Check &c = checks[slot];
+    deadlines.cancel(c.timer);
+    c.timer = 0;
+    c.reply = nullptr;
+    freeChecks.append(slot);
 }
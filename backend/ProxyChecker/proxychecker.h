@@ -1,6 +1,9 @@
 #ifndef PROXYCHECKER_H
 #define PROXYCHECKER_H
 
+#include "../IpAddress/ipaddress.h"
+#include "../TimerWheel/timerwheel.h"
+#include "../ScanStatistics/scanstatistics.h"
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkConfiguration>
@@ -9,26 +12,75 @@
 #include <QNetworkReply>
 #include <QHostAddress>
 #include <QNetworkProxy>
+#include <QTcpSocket>
 #include <QTimer>
+#include <QElapsedTimer>
 
-class ProxyChecker : public QNetworkAccessManager
+// Checks assigned to one worker thread. Many checks can be in flight at the
+// same time, each one through its own proxy, so every check slot has its own
+// network access manager, reused by the checks taking the slot after it.
+// With a connect timeout, a plain TCP connection is tried first and only the
+// hosts accepting it go on to the proxy check. The deadlines of all the checks
+// share a timer wheel driven by a single timer.
+class ProxyChecker : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit ProxyChecker(const QNetworkProxy &proxy, int connectionTimeout = 200, QObject *parent = nullptr);
+    explicit ProxyChecker(const QNetworkRequest &request, QNetworkProxy::ProxyType type,
+                          int connectionTimeout = 200, int tcpConnectTimeout = 0, QObject *parent = nullptr);
 
-    QString getHostName() const;
-    unsigned short getPort() const;
+    int getTimeout() const;
+    int getConnectTimeout() const;
+    // Records the connect and first byte times, from the checker thread
+    void setStatistics(ScanStatistics::Shard *shard);
+
+    static int errorFromSocketError(QAbstractSocket::SocketError socketError);
 
 signals:
+    void replied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols);
 
 public slots:
-    void start(const QNetworkRequest &request);
+    void start(quint64 sequence, const IpAddress &address, unsigned short port, int checkTimeout = -1);
     void stop();
 
+private slots:
+    void onFinished(QNetworkReply *reply);
+    void onTick();
+
 private:
+    struct Check {
+        quint64 sequence = 0;
+        IpAddress address;
+        unsigned short port = 0;
+        int timeout = 0;
+        quint64 timer = 0;
+        QNetworkAccessManager *manager = nullptr; // of the slot, created by its first check
+        QTcpSocket *socket = nullptr; // while connecting, with the sweep
+        QNetworkReply *reply = nullptr; // while checking the proxy
+        qint64 stageStartedAt = 0; // ns, of the connection or the request
+    };
+
+    void check(int slot);
+    void arm(int slot, int checkTimeout);
+    void schedule();
+    void finishConnect(int slot);
+    void finish(int slot, int error, const QString &reason);
+    void release(int slot);
+
+    QNetworkRequest networkRequest;
+    QNetworkProxy::ProxyType proxyType = QNetworkProxy::HttpCachingProxy;
     int timeout = 2000;
+    int connectTimeout = 0;
+
+    QVector<Check> checks;
+    QVector<int> freeChecks;
+    TimerWheel deadlines;
+    QVector<quint64> expired;
+    QTimer tick;
+    qint64 tickDeadline = -1;
+    QElapsedTimer clock;
+    ScanStatistics::Shard *statistics = nullptr;
 };
 
 #endif // PROXYCHECKER_H
@@ -0,0 +1,62 @@
+#include "proxycheckerpool.h"
+
+ProxyCheckerPool::ProxyCheckerPool(const QNetworkRequest &request, QNetworkProxy::ProxyType type, int connectionTimeout,
+                                   int tcpConnectTimeout, int workers, QObject *parent) : ProbeEngine(parent)
+{
+    if (workers < 1) {
+        workers = 1;
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        QThread *thread = new QThread(this);
+        ProxyChecker *checker = new ProxyChecker(request, type, connectionTimeout, tcpConnectTimeout);
+        checker->moveToThread(thread);
+        connect(thread, &QThread::finished, checker, &ProxyChecker::deleteLater);
+        connect(checker, &ProxyChecker::replied, this, &ProxyCheckerPool::replied);
+        threads.append(thread);
+        checkers.append(checker);
+        thread->start();
+    }
+}
+
+ProxyCheckerPool::~ProxyCheckerPool()
+{
+    stop();
+    for (auto thread : threads) {
+        thread->quit();
+    }
+    for (auto thread : threads) {
+        thread->wait();
+    }
+}
+
+int ProxyCheckerPool::getWorkerCount() const
+{
+    return checkers.count();
+}
+
+void ProxyCheckerPool::setStatistics(ScanStatistics *statistics)
+{
+    for (auto checker : checkers) {
+        ScanStatistics::Shard *shard = statistics ? statistics->createShard() : nullptr;
+        QMetaObject::invokeMethod(checker, [=] {
+            checker->setStatistics(shard);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ProxyCheckerPool::start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout)
+{
+    ProxyChecker *checker = checkers[nextWorker];
+    nextWorker = (nextWorker + 1) % checkers.count();
+    QMetaObject::invokeMethod(checker, [=] {
+        checker->start(sequence, address, port, timeout);
+    }, Qt::QueuedConnection);
+}
+
+void ProxyCheckerPool::stop()
+{
+    for (auto checker : checkers) {
+        QMetaObject::invokeMethod(checker, &ProxyChecker::stop, Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef PROXYCHECKERPOOL_H
+#define PROXYCHECKERPOOL_H
+
+#include "../ProbeEngine/probeengine.h"
+#include "../ProxyChecker/proxychecker.h"
+#include <QThread>
+
+// Fixed set of long-lived worker threads, each one running its own event loop
+// and owning a single ProxyChecker. Checks are spread among the workers, so
+// the threads and network stacks created depend on the workers count and not
+// on the number of addresses to scan.
+class ProxyCheckerPool : public ProbeEngine
+{
+    Q_OBJECT
+
+public:
+    explicit ProxyCheckerPool(const QNetworkRequest &request, QNetworkProxy::ProxyType type, int connectionTimeout = 2000,
+                              int tcpConnectTimeout = 0, int workers = QThread::idealThreadCount(), QObject *parent = nullptr);
+    ~ProxyCheckerPool() override;
+
+    int getWorkerCount() const;
+    void setStatistics(ScanStatistics *statistics) override;
+
+public slots:
+    void start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout = -1) override;
+    void stop() override;
+
+private:
+    QList<QThread*> threads;
+    QList<ProxyChecker*> checkers;
+    int nextWorker = 0;
+};
+
+#endif // PROXYCHECKERPOOL_H
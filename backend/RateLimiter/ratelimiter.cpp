@@ -0,0 +1,63 @@
+#include "ratelimiter.h"
+#include <cmath>
+
+static const double TimerTicks = 2e6; // ns accrued by the bucket at least, two millisecond ticks
+
+RateLimiter::RateLimiter(double rate, int burst)
+{
+    configure(rate, burst);
+    reset(0);
+}
+
+void RateLimiter::configure(double rate, int burst)
+{
+    this->rate = qMax(rate, 0.0) / 1e9;
+    capacity = qMax(qMax(double(burst), this->rate * TimerTicks), 1.0);
+    tokens = qMin(tokens, capacity);
+}
+
+bool RateLimiter::isLimited() const
+{
+    return rate > 0;
+}
+
+void RateLimiter::reset(qint64 now)
+{
+    tokens = capacity;
+    last = now;
+}
+
+bool RateLimiter::tryAcquire(qint64 now)
+{
+    if (!isLimited()) {
+        return true;
+    }
+    tokens = tokensAt(now);
+    last = now;
+    if (tokens < 1) {
+        return false;
+    }
+    tokens -= 1;
+    return true;
+}
+
+void RateLimiter::refund()
+{
+    if (isLimited()) {
+        tokens = qMin(capacity, tokens + 1);
+    }
+}
+
+qint64 RateLimiter::nextTokenIn(qint64 now) const
+{
+    const double available = tokensAt(now);
+    if (!isLimited() || available >= 1) {
+        return 0;
+    }
+    return qint64(std::ceil((1 - available) / rate));
+}
+
+double RateLimiter::tokensAt(qint64 now) const
+{
+    return qMin(capacity, tokens + double(now - last) * rate);
+}
@@ -0,0 +1,36 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QtGlobal>
+
+// Token bucket smoothing how fast the checks start. Tokens accrue at the
+// configured rate from a monotonic clock, up to the burst, and every check
+// takes one. The caller sleeps on a timer until the next token instead of
+// polling, so the bucket always holds at least what accrues in a couple of
+// timer ticks, otherwise a high rate couldn't be kept with millisecond timers.
+class RateLimiter
+{
+public:
+    explicit RateLimiter(double rate = 0, int burst = 1);
+
+    // A rate of 0 disables the limiter
+    void configure(double rate, int burst);
+    bool isLimited() const;
+
+    // Times are in nanoseconds, of any monotonic clock
+    void reset(qint64 now);
+    bool tryAcquire(qint64 now);
+    // Gives back a token acquired for nothing
+    void refund();
+    qint64 nextTokenIn(qint64 now) const;
+
+private:
+    double tokensAt(qint64 now) const;
+
+    double rate = 0; // tokens per nanosecond
+    double capacity = 1;
+    double tokens = 1;
+    qint64 last = 0;
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,116 @@
+#include "resultsink.h"
+#include "../ProxyBenchmark/proxybenchmark.h"
+
+static bool isBenchmarked(const ScanResult &result)
+{
+    return result.benchmark.samples > 0 || result.benchmark.anonymity != 0;
+}
+
+ResultSink::~ResultSink()
+{
+}
+
+QByteArray ResultSink::header() const
+{
+    return QByteArray();
+}
+
+ResultSink *ResultSink::create(Format format)
+{
+    switch (format) {
+    case CSV:
+        return new CsvSink;
+    case NDJSON:
+    default:
+        return new NdjsonSink;
+    }
+}
+
+void NdjsonSink::append(const ScanResult &result, QByteArray &buffer) const
+{
+    buffer += "{\"address\":\"";
+    buffer += result.address.toString().toLatin1();
+    buffer += "\",\"port\":";
+    buffer += QByteArray::number(result.port);
+    buffer += ",\"error\":";
+    buffer += QByteArray::number(result.error);
+    buffer += ",\"reason\":\"";
+    for (const char c : result.reason.toUtf8()) {
+        switch (c) {
+        case '"': buffer += "\\\""; break;
+        case '\\': buffer += "\\\\"; break;
+        case '\n': buffer += "\\n"; break;
+        case '\r': buffer += "\\r"; break;
+        case '\t': buffer += "\\t"; break;
+        default:
+            if (uchar(c) < 0x20) {
+                buffer += "\\u00";
+                buffer += QByteArray::number(uchar(c), 16).rightJustified(2, '0');
+            } else {
+                buffer += c;
+            }
+        }
+    }
+    buffer += "\",\"latency\":";
+    buffer += QByteArray::number(result.latency);
+    buffer += ",\"time\":";
+    buffer += QByteArray::number(result.timestamp);
+    buffer += ",\"protocols\":";
+    buffer += QByteArray::number(result.protocols);
+    if (isBenchmarked(result)) {
+        const BenchmarkResult &benchmark = result.benchmark;
+        buffer += ",\"benchmark\":{\"samples\":";
+        buffer += QByteArray::number(benchmark.samples);
+        buffer += ",\"connect\":";
+        buffer += QByteArray::number(benchmark.connectTime);
+        buffer += ",\"ttfb\":";
+        buffer += QByteArray::number(benchmark.firstByteTime);
+        buffer += ",\"ttfb90\":";
+        buffer += QByteArray::number(benchmark.firstByteTime90);
+        buffer += ",\"throughput\":";
+        buffer += QByteArray::number(benchmark.throughput);
+        buffer += ",\"anonymity\":\"";
+        buffer += ProxyBenchmark::anonymityName(benchmark.anonymity).toLatin1();
+        buffer += "\"}";
+    }
+    buffer += "}\n";
+}
+
+QByteArray CsvSink::header() const
+{
+    return QByteArrayLiteral("address,port,error,reason,latency,time,protocols,connect,ttfb,ttfb90,throughput,anonymity\r\n");
+}
+
+void CsvSink::append(const ScanResult &result, QByteArray &buffer) const
+{
+    buffer += result.address.toString().toLatin1();
+    buffer += ',';
+    buffer += QByteArray::number(result.port);
+    buffer += ',';
+    buffer += QByteArray::number(result.error);
+    buffer += ",\"";
+    buffer += result.reason.toUtf8().replace('"', "\"\"");
+    buffer += "\",";
+    buffer += QByteArray::number(result.latency);
+    buffer += ',';
+    buffer += QByteArray::number(result.timestamp);
+    buffer += ',';
+    buffer += QByteArray::number(result.protocols);
+    // Empty unless benchmarked
+    if (isBenchmarked(result)) {
+        const BenchmarkResult &benchmark = result.benchmark;
+        buffer += ',';
+        buffer += QByteArray::number(benchmark.connectTime);
+        buffer += ',';
+        buffer += QByteArray::number(benchmark.firstByteTime);
+        buffer += ',';
+        buffer += QByteArray::number(benchmark.firstByteTime90);
+        buffer += ',';
+        buffer += QByteArray::number(benchmark.throughput);
+        buffer += ',';
+        buffer += ProxyBenchmark::anonymityName(benchmark.anonymity).toLatin1();
+    } else {
+        buffer += ",,,,,";
+    }
+    buffer += "\r\n";
+}
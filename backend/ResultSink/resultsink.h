@@ -0,0 +1,38 @@
+#ifndef RESULTSINK_H
+#define RESULTSINK_H
+
+#include "../ScanResult/scanresult.h"
+#include <QByteArray>
+#include <QString>
+
+// Serialization of the results into a stream of records. A sink only
+// formats: the file handling belongs to ResultWriter.
+class ResultSink
+{
+public:
+    enum Format { NDJSON, CSV };
+
+    virtual ~ResultSink();
+
+    virtual QByteArray header() const;
+    virtual void append(const ScanResult &result, QByteArray &buffer) const = 0;
+
+    static ResultSink *create(Format format);
+};
+
+// One JSON object per line
+class NdjsonSink : public ResultSink
+{
+public:
+    void append(const ScanResult &result, QByteArray &buffer) const override;
+};
+
+// RFC 4180 comma separated values, with a header row
+class CsvSink : public ResultSink
+{
+public:
+    QByteArray header() const override;
+    void append(const ScanResult &result, QByteArray &buffer) const override;
+};
+
+#endif // RESULTSINK_H
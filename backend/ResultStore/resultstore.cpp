@@ -0,0 +1,150 @@
+#include "resultstore.h"
+#include <algorithm>
+#include <limits>
+
+// Reason phrases past the table capacity are stored as the empty one, at index 0
+static const int MaxReasonPhrases = std::numeric_limits<quint16>::max();
+
+ResultStore::ResultStore()
+{
+    reasonPhrases.append(QString());
+    reasonIndexes.insert(QString(), 0);
+}
+
+bool ResultStore::append(const ScanResult &result)
+{
+    QWriteLocker locker(&lock);
+    const int row = ports.count();
+
+    if (result.address.isIPv4()) {
+        addresses.append(result.address.toIPv4());
+        ipv6Rows.resize(row + 1);
+    } else {
+        addresses.append(quint32(ipv6Addresses.count()));
+        ipv6Addresses.append(result.address);
+        ipv6Rows.resize(row + 1);
+        ipv6Rows.setBit(row);
+    }
+    ports.append(result.port);
+
+    auto error = errorIndexes.constFind(result.error);
+    if (error == errorIndexes.constEnd()) {
+        error = errorIndexes.insert(result.error, quint16(errorCodes.count()));
+        errorCodes.append(result.error);
+        buckets.append(QVector<int>());
+    }
+    errors.append(error.value());
+    buckets[error.value()].append(row);
+
+    auto reason = reasonIndexes.constFind(result.reason);
+    if (reason != reasonIndexes.constEnd()) {
+        reasons.append(reason.value());
+    } else if (reasonPhrases.count() < MaxReasonPhrases) {
+        reasonIndexes.insert(result.reason, quint16(reasonPhrases.count()));
+        reasons.append(quint16(reasonPhrases.count()));
+        reasonPhrases.append(result.reason);
+    } else {
+        reasons.append(0);
+    }
+    timestamps.append(result.timestamp);
+    latencies.append(result.latency);
+    protocols.append(result.protocols);
+    if (result.benchmark.samples > 0 || result.benchmark.anonymity != 0) {
+        benchmarks.insert(row, result.benchmark);
+    }
+
+    return filter.contains(result.error);
+}
+
+void ResultStore::clear()
+{
+    QWriteLocker locker(&lock);
+    addresses.clear();
+    ipv6Rows.clear();
+    ipv6Addresses.clear();
+    ports.clear();
+    errors.clear();
+    reasons.clear();
+    timestamps.clear();
+    latencies.clear();
+    protocols.clear();
+    benchmarks.clear();
+    errorCodes.clear();
+    errorIndexes.clear();
+    reasonPhrases.resize(1);
+    reasonIndexes.clear();
+    reasonIndexes.insert(QString(), 0);
+    buckets.clear();
+    filterGeneration++;
+}
+
+int ResultStore::count() const
+{
+    QReadLocker locker(&lock);
+    return ports.count();
+}
+
+bool ResultStore::at(int row, ScanResult *result) const
+{
+    QReadLocker locker(&lock);
+    if (row < 0 || row >= ports.count()) {
+        return false;
+    }
+    *result = resultAt(row);
+    return true;
+}
+
+void ResultStore::setFilter(const QSet<int> &codes)
+{
+    QWriteLocker locker(&lock);
+    filter = codes;
+    filterCodes = QVector<int>(codes.cbegin(), codes.cend());
+    std::sort(filterCodes.begin(), filterCodes.end());
+    filterGeneration++;
+}
+
+QVector<int> ResultStore::filteredBucketSizes(quint32 *generation) const
+{
+    QReadLocker locker(&lock);
+    if (generation) {
+        *generation = filterGeneration;
+    }
+
+    // Codes not seen yet have an empty bucket
+    QVector<int> sizes(filterCodes.count(), 0);
+    for (int i = 0; i < filterCodes.count(); ++i) {
+        const auto error = errorIndexes.constFind(filterCodes[i]);
+        if (error != errorIndexes.constEnd()) {
+            sizes[i] = buckets[error.value()].count();
+        }
+    }
+    return sizes;
+}
+
+bool ResultStore::filteredAt(quint32 generation, int bucket, int position, ScanResult *result) const
+{
+    QReadLocker locker(&lock);
+    if (generation != filterGeneration || bucket < 0 || bucket >= filterCodes.count()) {
+        return false;
+    }
+    const auto error = errorIndexes.constFind(filterCodes[bucket]);
+    if (error == errorIndexes.constEnd() || position < 0 || position >= buckets[error.value()].count()) {
+        return false;
+    }
+    *result = resultAt(buckets[error.value()][position]);
+    return true;
+}
+
+ScanResult ResultStore::resultAt(int row) const
+{
+    ScanResult result;
+    result.address = ipv6Rows.testBit(row) ? ipv6Addresses[int(addresses[row])] : IpAddress::fromIPv4(addresses[row]);
+    result.port = ports[row];
+    result.error = errorCodes[errors[row]];
+    result.reason = reasonPhrases[reasons[row]];
+    result.timestamp = timestamps[row];
+    result.latency = latencies[row];
+    result.protocols = protocols[row];
+    result.benchmark = benchmarks.value(row);
+    return result;
+}
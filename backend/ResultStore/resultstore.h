@@ -0,0 +1,63 @@
+#ifndef RESULTSTORE_H
+#define RESULTSTORE_H
+
+#include "../ScanResult/scanresult.h"
+#include <QVector>
+#include <QBitArray>
+#include <QHash>
+#include <QSet>
+#include <QReadWriteLock>
+
+// Results of a scan kept column by column, about 27 bytes per result with
+// the row in its bucket: IPv4 addresses inline and IPv6 ones apart, error
+// codes and reason phrases interned in small tables, the timestamp and the
+// latency in microseconds. The benchmarks of the few proxies measured are
+// kept apart, by row. Rows are also bucketed by error code as they arrive,
+// and the filtered view is the concatenation of the buckets of the filtered
+// codes, so changing the filter never walks the rows. Written by the finder
+// thread and read by the models, behind a lock.
+class ResultStore
+{
+public:
+    ResultStore();
+
+    // Thread safe
+    bool append(const ScanResult &result);
+    void clear();
+    int count() const;
+    bool at(int row, ScanResult *result) const;
+
+    // The filtered view: one bucket per filtered code, in ascending order
+    void setFilter(const QSet<int> &codes);
+    QVector<int> filteredBucketSizes(quint32 *generation = nullptr) const;
+    bool filteredAt(quint32 generation, int bucket, int position, ScanResult *result) const;
+
+private:
+    ScanResult resultAt(int row) const;
+
+    mutable QReadWriteLock lock;
+
+    QVector<quint32> addresses; // IPv4 address, or index in ipv6Addresses
+    QBitArray ipv6Rows;
+    QVector<IpAddress> ipv6Addresses;
+    QVector<quint16> ports;
+    QVector<quint16> errors; // index in errorCodes
+    QVector<quint16> reasons; // index in reasonPhrases
+    QVector<qint64> timestamps;
+    QVector<quint32> latencies;
+    QVector<quint8> protocols;
+    QHash<int, BenchmarkResult> benchmarks; // by row, only the benchmarked ones
+
+    QVector<int> errorCodes;
+    QHash<int, quint16> errorIndexes;
+    QVector<QString> reasonPhrases;
+    QHash<QString, quint16> reasonIndexes;
+
+    QVector<QVector<int>> buckets; // rows of every error code, by index in errorCodes
+
+    QSet<int> filter;
+    QVector<int> filterCodes; // sorted
+    quint32 filterGeneration = 0; // changes whenever the view does other than growing
+};
+
+#endif // RESULTSTORE_H
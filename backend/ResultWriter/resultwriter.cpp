@@ -0,0 +1,123 @@
+#include "resultwriter.h"
+#include <QFile>
+
+// Buffered bytes that wake the writer before its interval ends
+static const int HighWaterMark = 1 << 20;
+
+ResultWriter::ResultWriter(const QString &fileName, ResultSink *resultSink, int flushInterval, QObject *parent)
+    : QThread(parent), fileName(fileName), sink(resultSink), interval(flushInterval)
+{
+}
+
+ResultWriter::~ResultWriter()
+{
+    finish();
+    wait();
+}
+
+void ResultWriter::run()
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        fail(file.errorString());
+        return;
+    }
+    if (file.size() == 0) {
+        file.write(sink->header());
+    }
+    bytesWritten.storeRelease(file.size());
+    // Checkpoint offsets are counted from here
+    const qint64 firstResultOffset = file.size();
+
+    QByteArray buffer;
+    ScanCheckpoint state;
+    QString stateFileName;
+    bool done = false;
+    while (!done) {
+        mutex.lock();
+        if (!finishRequested && !checkpointRequested && pending.size() < HighWaterMark) {
+            condition.wait(&mutex, ulong(interval));
+        }
+        buffer.swap(pending);
+        const bool saveCheckpoint = checkpointRequested;
+        if (saveCheckpoint) {
+            state = pendingCheckpoint;
+            stateFileName = checkpointFileName;
+            checkpointRequested = false;
+        }
+        done = finishRequested;
+        mutex.unlock();
+
+        if (!buffer.isEmpty()) {
+            // Flushed on every round, so the results survive a crash of the scan
+            if (file.write(buffer) != buffer.size() || !file.flush()) {
+                fail(file.errorString());
+                return;
+            }
+            bytesWritten.fetchAndAddRelease(buffer.size());
+            buffer.clear();
+        }
+        if (saveCheckpoint) {
+            // Results queued after the checkpoint are in the file too, but not covered by it
+            state.resultsOffset = firstResultOffset + state.resultsOffset;
+            if (!state.save(stateFileName)) {
+                emit failed(QStringLiteral("Unable to save the checkpoint ") + stateFileName);
+            }
+        }
+    }
+}
+
+void ResultWriter::fail(const QString &reason)
+{
+    // Later results are dropped instead of piling up in memory
+    mutex.lock();
+    finishRequested = true;
+    pending.clear();
+    mutex.unlock();
+    emit failed(reason);
+}
+
+void ResultWriter::write(const ScanResult &result)
+{
+    mutex.lock();
+    if (finishRequested) {
+        mutex.unlock();
+        return;
+    }
+    const int queued = pending.size();
+    sink->append(result, pending);
+    queuedBytes += pending.size() - queued;
+    if (pending.size() >= HighWaterMark) {
+        condition.wakeOne();
+    }
+    mutex.unlock();
+}
+
+bool ResultWriter::checkpoint(const ScanCheckpoint &state, const QString &checkpointFile)
+{
+    mutex.lock();
+    if (finishRequested) {
+        mutex.unlock();
+        return false;
+    }
+    pendingCheckpoint = state;
+    pendingCheckpoint.resultsOffset = queuedBytes;
+    checkpointFileName = checkpointFile;
+    checkpointRequested = true;
+    condition.wakeOne();
+    mutex.unlock();
+    return true;
+}
+
+void ResultWriter::finish()
+{
+    mutex.lock();
+    finishRequested = true;
+    condition.wakeOne();
+    mutex.unlock();
+}
+
+qint64 ResultWriter::getBytesWritten() const
+{
+    return bytesWritten.loadAcquire();
+}
@@ -0,0 +1,56 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include "../ResultSink/resultsink.h"
+#include "../ScanCheckpoint/scancheckpoint.h"
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QScopedPointer>
+#include <QAtomicInteger>
+
+// Appends the results to a file from its own thread. Callers only format
+// into a memory buffer; the thread swaps it out and writes it to disk every
+// flush interval, or as soon as it grows past a high-water mark, so a slow
+// disk never stalls the dispatch loop and the file is never far behind.
+// Checkpoints go through the same queue: each one points right after the
+// results queued before it, and is saved once they are in the file.
+class ResultWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit ResultWriter(const QString &fileName, ResultSink *resultSink, int flushInterval = 250, QObject *parent = nullptr);
+    ~ResultWriter() override;
+
+    void run() override;
+
+    // Thread safe
+    void write(const ScanResult &result);
+    // False once the writer failed or finished, the checkpoint is dropped then
+    bool checkpoint(const ScanCheckpoint &state, const QString &checkpointFile);
+    void finish();
+    qint64 getBytesWritten() const;
+
+signals:
+    void failed(const QString &reason);
+
+private:
+    void fail(const QString &reason);
+
+    QString fileName;
+    QScopedPointer<ResultSink> sink;
+    int interval = 250;
+
+    QMutex mutex;
+    QWaitCondition condition;
+    QByteArray pending; // guarded by mutex
+    qint64 queuedBytes = 0; // ever appended to pending, guarded by mutex
+    bool finishRequested = false; // guarded by mutex
+    bool checkpointRequested = false; // guarded by mutex
+    ScanCheckpoint pendingCheckpoint; // its offset relative to the first result, guarded by mutex
+    QString checkpointFileName; // guarded by mutex
+    QAtomicInteger<qint64> bytesWritten;
+};
+
+#endif // RESULTWRITER_H
@@ -0,0 +1,374 @@
+#include "revalidator.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <limits>
+
+// Live file updates are batched for this long
+static const int LiveFileDelay = 1000;
+
+static bool parseHostPort(const QByteArray &text, IpAddress *address, unsigned short *port)
+{
+    // address:port or [IPv6]:port
+    int colon;
+    int begin = 0, end;
+    if (text.startsWith('[')) {
+        end = text.indexOf(']');
+        colon = end + 1;
+        begin = 1;
+        if (end < 0 || colon >= text.size() || text.at(colon) != ':') {
+            return false;
+        }
+    } else {
+        colon = end = text.lastIndexOf(':');
+        if (colon < 0) {
+            return false;
+        }
+    }
+    bool ok = false;
+    const uint value = text.mid(colon + 1).toUInt(&ok);
+    if (!ok || value == 0 || value > 0xFFFF) {
+        return false;
+    }
+    *port = static_cast<unsigned short>(value);
+    return IpAddress::parse(text.constData() + begin, text.constData() + end, address);
+}
+
+Revalidator::Revalidator(ProbeEngine *engine, QObject *parent) : QObject(parent), engine(engine)
+{
+    connect(engine, &ProbeEngine::replied, this, &Revalidator::onReplied);
+
+    tick.setSingleShot(true);
+    tick.setTimerType(Qt::PreciseTimer);
+    connect(&tick, &QTimer::timeout, this, &Revalidator::onTick);
+
+    liveFileTimer.setSingleShot(true);
+    liveFileTimer.setInterval(LiveFileDelay);
+    connect(&liveFileTimer, &QTimer::timeout, this, &Revalidator::saveLiveFile);
+}
+
+Revalidator::~Revalidator()
+{
+    stop();
+}
+
+bool Revalidator::load(const QString &fileName, const QSet<int> &codes)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    hitCodes = codes;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        IpAddress address;
+        unsigned short port = 0;
+        bool hit = true;
+        if (line.startsWith('{')) {
+            // NDJSON results
+            const QJsonObject object = QJsonDocument::fromJson(line).object();
+            const QByteArray host = object.value("address").toString().toLatin1();
+            const int value = object.value("port").toInt();
+            if (!IpAddress::parse(host.constData(), host.constData() + host.size(), &address) || value <= 0 || value > 0xFFFF) {
+                continue;
+            }
+            port = static_cast<unsigned short>(value);
+            hit = !object.contains("error") || codes.contains(object.value("error").toInt());
+        } else if (line.contains(',')) {
+            // CSV results, the header row doesn't parse
+            const QList<QByteArray> fields = line.split(',');
+            bool ok = false;
+            const uint value = fields.value(1).toUInt(&ok);
+            if (!ok || value == 0 || value > 0xFFFF
+                    || !IpAddress::parse(fields.at(0).constData(), fields.at(0).constData() + fields.at(0).size(), &address)) {
+                continue;
+            }
+            port = static_cast<unsigned short>(value);
+            hit = fields.size() < 3 || codes.contains(fields.at(2).toInt());
+        } else {
+            // Command line output: address:port, then the error and the reason tab separated
+            const QList<QByteArray> fields = line.split('\t');
+            if (!parseHostPort(fields.at(0).trimmed(), &address, &port)) {
+                continue;
+            }
+            hit = fields.size() < 2 || codes.contains(fields.at(1).toInt());
+        }
+
+        if (hit && !known.contains(qMakePair(address, port))) {
+            known.insert(qMakePair(address, port));
+            Proxy proxy;
+            proxy.target = { address, port };
+            proxies.append(proxy);
+        }
+    }
+    return true;
+}
+
+int Revalidator::count() const
+{
+    return proxies.count();
+}
+
+int Revalidator::getInterval() const
+{
+    return interval;
+}
+
+void Revalidator::setInterval(int seconds)
+{
+    interval = qMax(1, seconds);
+}
+
+double Revalidator::getJitter() const
+{
+    return jitter;
+}
+
+void Revalidator::setJitter(double fraction)
+{
+    jitter = qBound(0.0, fraction, 1.0);
+}
+
+int Revalidator::getMaxFailures() const
+{
+    return maxFailures;
+}
+
+void Revalidator::setMaxFailures(int failures)
+{
+    maxFailures = qMax(1, failures);
+}
+
+int Revalidator::getConcurrency() const
+{
+    return concurrency;
+}
+
+void Revalidator::setConcurrency(int checks)
+{
+    concurrency = qMax(1, checks);
+}
+
+int Revalidator::getRounds() const
+{
+    return rounds;
+}
+
+void Revalidator::setRounds(int value)
+{
+    rounds = qMax(0, value);
+}
+
+int Revalidator::getTimeout() const
+{
+    return timeout;
+}
+
+void Revalidator::setTimeout(int milliseconds)
+{
+    timeout = milliseconds;
+}
+
+void Revalidator::setLiveFile(const QString &fileName)
+{
+    liveFile = fileName;
+}
+
+void Revalidator::setOutputFile(const QString &fileName, ResultSink::Format format)
+{
+    outputFile = fileName;
+    outputFormat = format;
+}
+
+int Revalidator::liveCount() const
+{
+    return live;
+}
+
+void Revalidator::start()
+{
+    if (running) {
+        return;
+    }
+    running = true;
+    clock.start();
+    schedules = TimerWheel(clock.elapsed());
+    due.clear();
+    inFlight = 0;
+    remaining = 0;
+    live = 0;
+
+    if (!outputFile.isEmpty()) {
+        resultWriter.reset(new ResultWriter(outputFile, ResultSink::create(outputFormat)));
+        resultWriter->start();
+    }
+
+    // The first round is spread over the whole interval
+    const qint64 period = qint64(interval) * 1000;
+    for (int i = 0; i < proxies.count(); ++i) {
+        Proxy &proxy = proxies[i];
+        proxy.failures = 0;
+        proxy.rounds = 0;
+        proxy.evicted = false;
+        remaining++;
+        live++;
+        reschedule(i, proxies.count() > 1 ? qint64(QRandomGenerator::global()->bounded(double(period))) : 0);
+    }
+    schedule();
+    checkFinished();
+}
+
+void Revalidator::stop()
+{
+    if (!running) {
+        return;
+    }
+    running = false;
+    tick.stop();
+    schedules.clear();
+    due.clear();
+    engine->stop();
+    liveFileTimer.stop();
+    if (!liveFile.isEmpty()) {
+        saveLiveFile();
+    }
+    resultWriter.reset();
+}
+
+void Revalidator::onReplied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols)
+{
+    if (!running || sequence >= quint64(proxies.count())) {
+        return;
+    }
+    inFlight--;
+    const int index = int(sequence);
+    Proxy &proxy = proxies[index];
+    if (resultWriter) {
+        const quint32 latency = quint32(qMin((clock.nsecsElapsed() - proxy.dispatchedAt) / 1000, qint64(std::numeric_limits<quint32>::max())));
+        resultWriter->write({ address, port, error, reason, QDateTime::currentMSecsSinceEpoch(), latency, quint8(protocols), BenchmarkResult() });
+    }
+    emit checked(address, port, error, reason);
+
+    const qint64 period = qint64(interval) * 1000;
+    if (error == QNetworkReply::TemporaryNetworkFailureError) {
+        // Says nothing about the proxy, it's checked again soon
+        reschedule(index, jittered(period / 16));
+    } else if (hitCodes.contains(error)) {
+        if (proxy.failures > 0) {
+            proxy.failures = 0;
+            live++;
+            scheduleLiveFile();
+        }
+        proxy.rounds++;
+        if (rounds > 0 && proxy.rounds >= rounds) {
+            remaining--;
+        } else {
+            reschedule(index, jittered(period));
+        }
+    } else {
+        if (proxy.failures++ == 0) {
+            live--;
+            scheduleLiveFile();
+        }
+        if (proxy.failures >= maxFailures) {
+            proxy.evicted = true;
+            remaining--;
+            emit evicted(address, port, proxy.failures);
+        } else {
+            // Failing proxies are given their remaining chances sooner
+            reschedule(index, jittered(period / 4));
+        }
+    }
+
+    dispatch();
+    schedule();
+    checkFinished();
+}
+
+void Revalidator::onTick()
+{
+    expired.clear();
+    schedules.advance(clock.elapsed(), expired);
+    for (quint64 data : expired) {
+        due.enqueue(int(data));
+    }
+    dispatch();
+    schedule();
+}
+
+void Revalidator::dispatch()
+{
+    while (inFlight < concurrency && !due.isEmpty()) {
+        const int index = due.dequeue();
+        inFlight++;
+        proxies[index].dispatchedAt = clock.nsecsElapsed();
+        engine->start(quint64(index), proxies[index].target.address, proxies[index].target.port, timeout);
+    }
+}
+
+void Revalidator::reschedule(int index, qint64 delay)
+{
+    schedules.start(clock.elapsed() + delay, quint64(index));
+}
+
+void Revalidator::schedule()
+{
+    const qint64 next = schedules.nextExpiry();
+    if (next < 0) {
+        tick.stop();
+        return;
+    }
+    tick.start(int(qMax<qint64>(0, next - clock.elapsed())));
+}
+
+qint64 Revalidator::jittered(qint64 delay) const
+{
+    // Uniform in delay ± jitter, so proxies found together drift apart
+    const double spread = delay * jitter;
+    return qMax<qint64>(1, delay + qint64(spread * (2 * QRandomGenerator::global()->generateDouble() - 1)));
+}
+
+void Revalidator::scheduleLiveFile()
+{
+    if (!liveFile.isEmpty() && !liveFileTimer.isActive()) {
+        liveFileTimer.start();
+    }
+}
+
+void Revalidator::saveLiveFile()
+{
+    // Written aside and renamed, so readers never see a partial list
+    QSaveFile file(liveFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QByteArray buffer;
+    for (const Proxy &proxy : proxies) {
+        if (proxy.evicted || proxy.failures > 0) {
+            continue;
+        }
+        const IpAddress &address = proxy.target.address;
+        const QByteArray host = address.toString().toLatin1();
+        buffer += address.isIPv4() ? host : '[' + host + ']';
+        buffer += ':' + QByteArray::number(proxy.target.port) + '\n';
+    }
+    file.write(buffer);
+    file.commit();
+}
+
+void Revalidator::checkFinished()
+{
+    if (running && remaining == 0 && inFlight == 0) {
+        stop();
+        emit finished();
+    }
+}
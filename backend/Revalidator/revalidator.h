@@ -0,0 +1,112 @@
+#ifndef REVALIDATOR_H
+#define REVALIDATOR_H
+
+#include "../ProbeEngine/probeengine.h"
+#include "../TargetGenerator/targetgenerator.h"
+#include "../TimerWheel/timerwheel.h"
+#include "../ResultWriter/resultwriter.h"
+#include <QObject>
+#include <QVector>
+#include <QQueue>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+
+// Keeps a pool of known proxies fresh without scanning their ranges again.
+// Every proxy is checked once per interval, at a jittered time so the checks
+// spread evenly, and sooner while it's failing. Proxies failing a number of
+// checks in a row are evicted; local errors don't count as failures.
+class Revalidator : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Takes ownership of the engine
+    explicit Revalidator(ProbeEngine *engine, QObject *parent = nullptr);
+    ~Revalidator() override;
+
+    // Appends the hits of a results file (NDJSON or CSV) or of the command
+    // line output, whose error is one of the codes. Returns false if it can't be read.
+    bool load(const QString &fileName, const QSet<int> &codes);
+    int count() const;
+
+    // In seconds
+    int getInterval() const;
+    void setInterval(int seconds);
+    // Fraction of the interval the checks are moved by, at random
+    double getJitter() const;
+    void setJitter(double fraction);
+    int getMaxFailures() const;
+    void setMaxFailures(int failures);
+    int getConcurrency() const;
+    void setConcurrency(int checks);
+    // Rounds over every proxy, 0 to run until stopped
+    int getRounds() const;
+    void setRounds(int value);
+    int getTimeout() const;
+    void setTimeout(int milliseconds);
+    // Rewritten with the live proxies whenever the set changes
+    void setLiveFile(const QString &fileName);
+    // Every check is appended to it
+    void setOutputFile(const QString &fileName, ResultSink::Format format);
+
+    int liveCount() const;
+
+signals:
+    void checked(const IpAddress &address, unsigned short port, int error, const QString &reason);
+    void evicted(const IpAddress &address, unsigned short port, int failures);
+    void finished();
+
+public slots:
+    void start();
+    void stop();
+
+private:
+    struct Proxy {
+        ScanTarget target;
+        int failures = 0;
+        int rounds = 0;
+        bool evicted = false;
+        qint64 dispatchedAt = 0; // ns on the clock
+    };
+
+    void onReplied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols);
+    void onTick();
+    void dispatch();
+    void reschedule(int index, qint64 delay);
+    void schedule();
+    qint64 jittered(qint64 delay) const;
+    void scheduleLiveFile();
+    void saveLiveFile();
+    void checkFinished();
+
+    QScopedPointer<ProbeEngine> engine;
+    QScopedPointer<ResultWriter> resultWriter;
+    QVector<Proxy> proxies;
+    QSet<QPair<IpAddress, unsigned short>> known;
+    QSet<int> hitCodes;
+    QQueue<int> due; // waiting for a free slot
+    int inFlight = 0;
+    int remaining = 0; // neither evicted nor done with their rounds
+    int live = 0;
+
+    int interval = 300;
+    double jitter = 0.2;
+    int maxFailures = 3;
+    int concurrency = 100;
+    int rounds = 0;
+    int timeout = -1;
+    QString liveFile;
+    QString outputFile;
+    ResultSink::Format outputFormat = ResultSink::NDJSON;
+
+    TimerWheel schedules;
+    QVector<quint64> expired;
+    QTimer tick;
+    QTimer liveFileTimer;
+    QElapsedTimer clock;
+    bool running = false;
+};
+
+#endif // REVALIDATOR_H
@@ -0,0 +1,83 @@
+#include "rttestimator.h"
+#include <QNetworkReply>
+#include <cmath>
+
+static const double Alpha = 0.125;
+static const double Beta = 0.25;
+static const double K = 4;
+static const int MaximumNetworks = 65536; // forgotten all at once past this, the scan estimate remains
+
+RttEstimator::RttEstimator(int minimumTimeout, int maximumTimeout)
+{
+    setBounds(minimumTimeout, maximumTimeout);
+}
+
+void RttEstimator::setBounds(int minimumTimeout, int maximumTimeout)
+{
+    minimum = qMax(1, minimumTimeout);
+    maximum = qMax(minimum, maximumTimeout);
+}
+
+void RttEstimator::clear()
+{
+    scan = Estimate();
+    networks.clear();
+}
+
+void RttEstimator::addSample(const IpAddress &address, qint64 rtt)
+{
+    const double milliseconds = double(rtt) / 1000;
+    scan.update(milliseconds);
+    if (networks.count() >= MaximumNetworks) {
+        networks.clear();
+    }
+    networks[networkOf(address)].update(milliseconds);
+}
+
+int RttEstimator::timeoutFor(const IpAddress &address) const
+{
+    const auto it = networks.constFind(networkOf(address));
+    if (it != networks.constEnd()) {
+        return it->timeout(minimum, maximum);
+    }
+    return scan.timeout(minimum, maximum);
+}
+
+bool RttEstimator::isProxyAnswer(int error)
+{
+    switch (error) {
+    case QNetworkReply::NoError:
+    case QNetworkReply::ProxyAuthenticationRequiredError:
+    case QNetworkReply::ProtocolInvalidOperationError: // 400
+        return true;
+    default:
+        // The content and server errors map the other HTTP statuses
+        return (error >= QNetworkReply::ContentAccessDenied && error <= QNetworkReply::UnknownContentError)
+                || (error >= QNetworkReply::InternalServerError && error <= QNetworkReply::UnknownServerError);
+    }
+}
+
+void RttEstimator::Estimate::update(double rtt)
+{
+    if (srtt < 0) {
+        srtt = rtt;
+        rttvar = rtt / 2;
+        return;
+    }
+    rttvar = (1 - Beta) * rttvar + Beta * std::fabs(srtt - rtt);
+    srtt = (1 - Alpha) * srtt + Alpha * rtt;
+}
+
+int RttEstimator::Estimate::timeout(int minimum, int maximum) const
+{
+    // Nothing known yet, so nothing is cut short
+    if (srtt < 0) {
+        return maximum;
+    }
+    return qBound(minimum, int(std::ceil(srtt + K * rttvar)), maximum);
+}
+
+quint64 RttEstimator::networkOf(const IpAddress &address)
+{
+    return address.isIPv4() ? address.low() >> 8 : address.high();
+}
@@ -0,0 +1,48 @@
+#ifndef RTTESTIMATOR_H
+#define RTTESTIMATOR_H
+
+#include "../IpAddress/ipaddress.h"
+#include <QHash>
+
+// Round trip times of the hosts answering in each /24 (/64 for IPv6), smoothed
+// as TCP does for its retransmission timeout (RFC 6298). The timeout of a
+// check is the smoothed RTT plus four times its variation, from the estimate
+// of its network or of the whole scan while the network has none, always
+// within the configured bounds. Only the answers of proxies are sampled, as a
+// refused connection costs a single round trip while a check also waits for
+// the proxy to fetch the URL, so slow proxies raise the variation instead of
+// being cut short by the refusals of their neighbours.
+class RttEstimator
+{
+public:
+    explicit RttEstimator(int minimumTimeout = 250, int maximumTimeout = 1000);
+
+    // In milliseconds
+    void setBounds(int minimumTimeout, int maximumTimeout);
+    void clear();
+
+    // The round trip time is in microseconds
+    void addSample(const IpAddress &address, qint64 rtt);
+    int timeoutFor(const IpAddress &address) const;
+
+    // Whether the check got as far as an answer of the proxy: success or an HTTP status
+    static bool isProxyAnswer(int error);
+
+private:
+    struct Estimate {
+        double srtt = -1; // -1 until the first sample
+        double rttvar = 0;
+
+        void update(double rtt);
+        int timeout(int minimum, int maximum) const;
+    };
+
+    static quint64 networkOf(const IpAddress &address);
+
+    int minimum = 250;
+    int maximum = 1000;
+    Estimate scan;
+    QHash<quint64, Estimate> networks;
+};
+
+#endif // RTTESTIMATOR_H
@@ -0,0 +1,51 @@
+#include "scancheckpoint.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QDataStream>
+
+static const quint32 CheckpointMagic = 0x50464350; // "PFCP"
+static const quint32 CheckpointVersion = 2;
+
+bool ScanCheckpoint::save(const QString &fileName) const
+{
+    // Written aside and renamed, so a crash never leaves a torn checkpoint
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << CheckpointMagic << CheckpointVersion << fingerprint << watermark << completed << resultsOffset;
+    stream << quint32(prioritized.count());
+    for (const ScanTarget &target : prioritized) {
+        stream << target.address.high() << target.address.low() << quint16(target.port);
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool ScanCheckpoint::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (magic != CheckpointMagic || version != CheckpointVersion) {
+        return false;
+    }
+    stream >> fingerprint >> watermark >> completed >> resultsOffset;
+
+    quint32 count = 0;
+    stream >> count;
+    prioritized.clear();
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint64 high = 0, low = 0;
+        quint16 port = 0;
+        stream >> high >> low >> port;
+        prioritized.append({ IpAddress(high, low), port });
+    }
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,25 @@
+#ifndef SCANCHECKPOINT_H
+#define SCANCHECKPOINT_H
+
+#include "../TargetGenerator/targetgenerator.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Progress of a scan, compact enough to be saved every few seconds. Targets
+// are numbered in the order the generator produces them: every target below
+// the watermark is done, and so are the few listed above it and the live
+// proxies checked ahead of the scan. The results file holds exactly the
+// results of those targets up to resultsOffset.
+struct ScanCheckpoint {
+    QByteArray fingerprint; // of the scan parameters, a checkpoint only resumes the same scan
+    quint64 watermark = 0;
+    QVector<quint64> completed;
+    QVector<ScanTarget> prioritized; // checked ahead of the scan
+    qint64 resultsOffset = -1; // -1 without results file
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+};
+
+#endif // SCANCHECKPOINT_H
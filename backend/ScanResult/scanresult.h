@@ -0,0 +1,29 @@
+#ifndef SCANRESULT_H
+#define SCANRESULT_H
+
+#include "../IpAddress/ipaddress.h"
+#include <QString>
+
+// Measures of a proxy found, all 0 unless the hits are benchmarked
+struct BenchmarkResult {
+    quint8 samples; // successful downloads
+    quint8 anonymity; // ProxyBenchmark::Anonymity
+    quint32 connectTime; // us, median
+    quint32 firstByteTime; // us, median
+    quint32 firstByteTime90; // us, 90th percentile
+    quint32 throughput; // bytes/s, median
+};
+
+// Outcome of a single check
+struct ScanResult {
+    IpAddress address;
+    unsigned short port;
+    int error; // QNetworkReply::NetworkError
+    QString reason;
+    qint64 timestamp; // ms since epoch
+    quint32 latency; // us from dispatch to reply
+    quint8 protocols; // ProtocolDetector::Protocol flags, when detected
+    BenchmarkResult benchmark;
+};
+
+#endif // SCANRESULT_H
@@ -0,0 +1,76 @@
+#include "scanstatistics.h"
+
+static QVariantMap histogramToVariantMap(const LatencyHistogram::Snapshot &histogram)
+{
+    QVariantMap map;
+    map["count"] = double(histogram.count());
+    map["mean"] = histogram.mean();
+    map["p50"] = histogram.percentile(50);
+    map["p90"] = histogram.percentile(90);
+    map["p99"] = histogram.percentile(99);
+    map["max"] = histogram.max();
+    return map;
+}
+
+void ScanStatistics::Shard::recordOutcome(int error)
+{
+    QAtomicInteger<quint64> &count = outcomes[qBound(0, error, int(Outcomes) - 1)];
+    count.store(count.load() + 1);
+}
+
+QVariantMap ScanStatistics::Snapshot::toVariantMap() const
+{
+    QVariantMap outcomeCounts;
+    for (auto it = outcomes.constBegin(); it != outcomes.constEnd(); ++it) {
+        outcomeCounts[QString::number(it.key())] = double(it.value());
+    }
+
+    QVariantMap map;
+    map["connectTime"] = histogramToVariantMap(connectTime);
+    map["firstByteTime"] = histogramToVariantMap(firstByteTime);
+    map["totalTime"] = histogramToVariantMap(totalTime);
+    map["outcomes"] = outcomeCounts;
+    return map;
+}
+
+ScanStatistics::ScanStatistics()
+{
+}
+
+ScanStatistics::~ScanStatistics()
+{
+    clear();
+}
+
+ScanStatistics::Shard *ScanStatistics::createShard()
+{
+    Shard *shard = new Shard;
+    QMutexLocker locker(&mutex);
+    shards.append(shard);
+    return shard;
+}
+
+void ScanStatistics::clear()
+{
+    QMutexLocker locker(&mutex);
+    qDeleteAll(shards);
+    shards.clear();
+}
+
+ScanStatistics::Snapshot ScanStatistics::snapshot() const
+{
+    Snapshot snapshot;
+    QMutexLocker locker(&mutex);
+    for (const Shard *shard : shards) {
+        snapshot.connectTime.merge(shard->connectTime.snapshot());
+        snapshot.firstByteTime.merge(shard->firstByteTime.snapshot());
+        snapshot.totalTime.merge(shard->totalTime.snapshot());
+        for (int error = 0; error < Outcomes; ++error) {
+            const quint64 count = shard->outcomes[error].load();
+            if (count > 0) {
+                snapshot.outcomes[error] += count;
+            }
+        }
+    }
+    return snapshot;
+}
@@ -0,0 +1,59 @@
+#ifndef SCANSTATISTICS_H
+#define SCANSTATISTICS_H
+
+#include "../LatencyHistogram/latencyhistogram.h"
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QMap>
+#include <QVariantMap>
+#include <QVector>
+
+// Live statistics of a scan: latency histograms of the stages of the checks
+// and the outcomes by error code. Every thread recording owns a shard of its
+// own, so the hot path shares nothing with the other threads, and snapshots
+// add the shards up from any thread.
+class ScanStatistics
+{
+public:
+    // Error codes past it share the last counter
+    enum { Outcomes = 512 };
+
+    struct Shard {
+        LatencyHistogram connectTime; // until the proxy accepts the connection
+        LatencyHistogram firstByteTime; // from the request to the first byte answered
+        LatencyHistogram totalTime; // from dispatch to reply, as the finder sees it
+        QAtomicInteger<quint64> outcomes[Outcomes];
+
+        // Only from the owner thread, as the histograms
+        void recordOutcome(int error);
+    };
+
+    struct Snapshot {
+        LatencyHistogram::Snapshot connectTime;
+        LatencyHistogram::Snapshot firstByteTime;
+        LatencyHistogram::Snapshot totalTime;
+        QMap<int, quint64> outcomes;
+
+        // Microseconds: count, mean, p50, p90, p99 and max of every stage, and the outcomes by code
+        QVariantMap toVariantMap() const;
+    };
+
+    ScanStatistics();
+    ~ScanStatistics();
+
+    // Thread safe. The shard belongs to the statistics.
+    Shard *createShard();
+    // Drops the shards, once nothing records into them anymore
+    void clear();
+
+    // Thread safe
+    Snapshot snapshot() const;
+
+private:
+    Q_DISABLE_COPY(ScanStatistics)
+
+    mutable QMutex mutex;
+    QVector<Shard*> shards;
+};
+
+#endif // SCANSTATISTICS_H
@@ -97,20 +97,58 @@ void Settings::setFinalAddress(const QString &ip)
     }
 }
 
-unsigned short Settings::getPort()
+QString Settings::getTargets()
 {
-    if (contains("network/basic/port")) {
-        port = value("network/basic/port").value<unsigned short>();
+    if (contains("network/basic/targets")) {
+        targets = value("network/basic/targets").toString();
     }
-    return port;
+    return targets;
 }
 
-void Settings::setPort(unsigned short p)
+void Settings::setTargets(const QString &targetList)
 {
-    if (port != p) {
-        port = p;
-        setValue("network/basic/port", p);
-        emit portChanged(p);
+    if (targets != targetList) {
+        targets = targetList;
+        setValue("network/basic/targets", targetList);
+        emit targetsChanged(targetList);
+    }
+}
+
+QString Settings::getTargetsFile()
+{
+    if (contains("network/basic/targetsFile")) {
+        targetsFile = value("network/basic/targetsFile").toString();
+    }
+    return targetsFile;
+}
+
+void Settings::setTargetsFile(const QString &fileName)
+{
+    if (targetsFile != fileName) {
+        targetsFile = fileName;
+        setValue("network/basic/targetsFile", fileName);
+        emit targetsFileChanged(fileName);
+    }
+}
+
+QString Settings::getPorts()
+{
+    if (contains("network/basic/ports")) {
+        ports = value("network/basic/ports").toString();
+    } else if (contains("network/basic/port")) {
+        // Single port saved by older versions
+        ports = QString::number(value("network/basic/port").value<unsigned short>());
+    }
+    return ports;
+}
+
+void Settings::setPorts(const QString &portList)
+{
+    if (ports != portList) {
+        ports = portList;
+        setValue("network/basic/ports", portList);
+        remove("network/basic/port");
+        emit portsChanged(portList);
     }
 }
 
@@ -132,6 +170,278 @@ void Settings::setTimeout(int t)
     }
 }
 
+int Settings::getMinTimeout()
+{
+    if (contains("network/advanced/minTimeout")) {
+        minTimeout = value("network/advanced/minTimeout").toInt();
+    }
+    return minTimeout;
+}
+
+void Settings::setMinTimeout(int t)
+{
+    if (minTimeout != t) {
+        minTimeout = t;
+        setValue("network/advanced/minTimeout", t);
+        emit minTimeoutChanged(t);
+    }
+}
+
+bool Settings::getAdaptiveTimeout()
+{
+    if (contains("network/advanced/adaptiveTimeout")) {
+        adaptiveTimeout = value("network/advanced/adaptiveTimeout").toBool();
+    }
+    return adaptiveTimeout;
+}
+
+void Settings::setAdaptiveTimeout(bool enabled)
+{
+    if (adaptiveTimeout != enabled) {
+        adaptiveTimeout = enabled;
+        setValue("network/advanced/adaptiveTimeout", enabled);
+        emit adaptiveTimeoutChanged(enabled);
+    }
+}
+
+bool Settings::getConnectSweep()
+{
+    if (contains("network/advanced/connectSweep")) {
+        connectSweep = value("network/advanced/connectSweep").toBool();
+    }
+    return connectSweep;
+}
+
+void Settings::setConnectSweep(bool enabled)
+{
+    if (connectSweep != enabled) {
+        connectSweep = enabled;
+        setValue("network/advanced/connectSweep", enabled);
+        emit connectSweepChanged(enabled);
+    }
+}
+
+bool Settings::getResumeScans()
+{
+    if (contains("network/advanced/resumeScans")) {
+        resumeScans = value("network/advanced/resumeScans").toBool();
+    }
+    return resumeScans;
+}
+
+void Settings::setResumeScans(bool enabled)
+{
+    if (resumeScans != enabled) {
+        resumeScans = enabled;
+        setValue("network/advanced/resumeScans", enabled);
+        emit resumeScansChanged(enabled);
+    }
+}
+
+bool Settings::getUseHostCache()
+{
+    if (contains("network/advanced/useHostCache")) {
+        useHostCache = value("network/advanced/useHostCache").toBool();
+    }
+    return useHostCache;
+}
+
+void Settings::setUseHostCache(bool enabled)
+{
+    if (useHostCache != enabled) {
+        useHostCache = enabled;
+        setValue("network/advanced/useHostCache", enabled);
+        emit useHostCacheChanged(enabled);
+    }
+}
+
+int Settings::getLiveTtl()
+{
+    if (contains("network/advanced/liveTtl")) {
+        liveTtl = value("network/advanced/liveTtl").toInt();
+    }
+    return liveTtl;
+}
+
+void Settings::setLiveTtl(int minutes)
+{
+    if (liveTtl != minutes) {
+        liveTtl = minutes;
+        setValue("network/advanced/liveTtl", minutes);
+        emit liveTtlChanged(minutes);
+    }
+}
+
+int Settings::getRefusedTtl()
+{
+    if (contains("network/advanced/refusedTtl")) {
+        refusedTtl = value("network/advanced/refusedTtl").toInt();
+    }
+    return refusedTtl;
+}
+
+void Settings::setRefusedTtl(int minutes)
+{
+    if (refusedTtl != minutes) {
+        refusedTtl = minutes;
+        setValue("network/advanced/refusedTtl", minutes);
+        emit refusedTtlChanged(minutes);
+    }
+}
+
+int Settings::getDeadTtl()
+{
+    if (contains("network/advanced/deadTtl")) {
+        deadTtl = value("network/advanced/deadTtl").toInt();
+    }
+    return deadTtl;
+}
+
+void Settings::setDeadTtl(int minutes)
+{
+    if (deadTtl != minutes) {
+        deadTtl = minutes;
+        setValue("network/advanced/deadTtl", minutes);
+        emit deadTtlChanged(minutes);
+    }
+}
+
+bool Settings::getBenchmark()
+{
+    if (contains("network/advanced/benchmark")) {
+        benchmark = value("network/advanced/benchmark").toBool();
+    }
+    return benchmark;
+}
+
+void Settings::setBenchmark(bool enabled)
+{
+    if (benchmark != enabled) {
+        benchmark = enabled;
+        setValue("network/advanced/benchmark", enabled);
+        emit benchmarkChanged(enabled);
+    }
+}
+
+int Settings::getBenchmarkSamples()
+{
+    if (contains("network/advanced/benchmarkSamples")) {
+        benchmarkSamples = value("network/advanced/benchmarkSamples").toInt();
+    }
+    return benchmarkSamples;
+}
+
+void Settings::setBenchmarkSamples(int samples)
+{
+    if (benchmarkSamples != samples) {
+        benchmarkSamples = samples;
+        setValue("network/advanced/benchmarkSamples", samples);
+        emit benchmarkSamplesChanged(samples);
+    }
+}
+
+QString Settings::getJudgeUrl()
+{
+    if (contains("network/advanced/judgeUrl")) {
+        judgeUrl = value("network/advanced/judgeUrl").toString();
+    }
+    return judgeUrl;
+}
+
+void Settings::setJudgeUrl(const QString &url)
+{
+    if (judgeUrl != url) {
+        judgeUrl = url;
+        setValue("network/advanced/judgeUrl", url);
+        emit judgeUrlChanged(url);
+    }
+}
+
+int Settings::getConnectTimeout()
+{
+    if (contains("network/advanced/connectTimeout")) {
+        connectTimeout = value("network/advanced/connectTimeout").toInt();
+    }
+    return connectTimeout;
+}
+
+void Settings::setConnectTimeout(int t)
+{
+    if (connectTimeout != t) {
+        connectTimeout = t;
+        setValue("network/advanced/connectTimeout", t);
+        emit connectTimeoutChanged(t);
+    }
+}
+
+unsigned int Settings::getMinThreads()
+{
+    if (contains("network/advanced/minThreads")) {
+        minThreads = value("network/advanced/minThreads").toUInt();
+    }
+    return minThreads;
+}
+
+void Settings::setMinThreads(unsigned int n)
+{
+    if (minThreads != n) {
+        minThreads = n;
+        setValue("network/advanced/minThreads", n);
+        emit minThreadsChanged(n);
+    }
+}
+
+bool Settings::getAdaptiveConcurrency()
+{
+    if (contains("network/advanced/adaptiveConcurrency")) {
+        adaptiveConcurrency = value("network/advanced/adaptiveConcurrency").toBool();
+    }
+    return adaptiveConcurrency;
+}
+
+void Settings::setAdaptiveConcurrency(bool enabled)
+{
+    if (adaptiveConcurrency != enabled) {
+        adaptiveConcurrency = enabled;
+        setValue("network/advanced/adaptiveConcurrency", enabled);
+        emit adaptiveConcurrencyChanged(enabled);
+    }
+}
+
+int Settings::getRateLimit()
+{
+    if (contains("network/advanced/rateLimit")) {
+        rateLimit = value("network/advanced/rateLimit").toInt();
+    }
+    return rateLimit;
+}
+
+void Settings::setRateLimit(int n)
+{
+    if (rateLimit != n) {
+        rateLimit = n;
+        setValue("network/advanced/rateLimit", n);
+        emit rateLimitChanged(n);
+    }
+}
+
+int Settings::getRateBurst()
+{
+    if (contains("network/advanced/rateBurst")) {
+        rateBurst = value("network/advanced/rateBurst").toInt();
+    }
+    return rateBurst;
+}
+
+void Settings::setRateBurst(int n)
+{
+    if (rateBurst != n) {
+        rateBurst = n;
+        setValue("network/advanced/rateBurst", n);
+        emit rateBurstChanged(n);
+    }
+}
+
 unsigned int Settings::getMaxThreads()
 {
     if (contains("network/advanced/maxThreads")) {
@@ -149,6 +459,23 @@ void Settings::setMaxThreads(unsigned int n)
     }
 }
 
+int Settings::getWorkerThreads()
+{
+    if (contains("network/advanced/workerThreads")) {
+        workerThreads = value("network/advanced/workerThreads").toInt();
+    }
+    return workerThreads;
+}
+
+void Settings::setWorkerThreads(int n)
+{
+    if (workerThreads != n) {
+        workerThreads = n;
+        setValue("network/advanced/workerThreads", n);
+        emit workerThreadsChanged(n);
+    }
+}
+
 ThreadedFinder::RequestType Settings::getRequestType()
 {
     if (contains("network/advanced/requestType")) {
@@ -183,6 +510,58 @@ void Settings::setRequestUrl(const QString &url)
     }
 }
 
+ThreadedFinder::Engine Settings::getEngine()
+{
+    if (contains("network/advanced/engine")) {
+        engine = ThreadedFinder::Engine(value("network/advanced/engine").toInt());
+    }
+    return engine;
+}
+
+void Settings::setEngine(const ThreadedFinder::Engine &newEngine)
+{
+    if (engine != newEngine) {
+        engine = newEngine;
+        setValue("network/advanced/engine", int(newEngine));
+        emit engineChanged(newEngine);
+    }
+}
+
+// Output
+QString Settings::getOutputFile()
+{
+    if (contains("output/file")) {
+        outputFile = value("output/file").toString();
+    }
+    return outputFile;
+}
+
+void Settings::setOutputFile(const QString &fileName)
+{
+    if (outputFile != fileName) {
+        outputFile = fileName;
+        setValue("output/file", fileName);
+        emit outputFileChanged(fileName);
+    }
+}
+
+ThreadedFinder::OutputFormat Settings::getOutputFormat()
+{
+    if (contains("output/format")) {
+        outputFormat = ThreadedFinder::OutputFormat(value("output/format").toInt());
+    }
+    return outputFormat;
+}
+
+void Settings::setOutputFormat(const ThreadedFinder::OutputFormat &format)
+{
+    if (outputFormat != format) {
+        outputFormat = format;
+        setValue("output/format", int(format));
+        emit outputFormatChanged(format);
+    }
+}
+
 // Preferences
 int Settings::getTheme()
 {
@@ -267,25 +646,72 @@ void Settings::initialize()
         // Basics
         setValue("network/basic/initialAddress", initialAddress);
         setValue("network/basic/finalAddress", finalAddress);
-        setValue("network/basic/port", port);
+        setValue("network/basic/targets", targets);
+        setValue("network/basic/targetsFile", targetsFile);
+        setValue("network/basic/ports", ports);
         // Advanced
         setValue("network/advanced/timeout", timeout);
+        setValue("network/advanced/minTimeout", minTimeout);
+        setValue("network/advanced/adaptiveTimeout", adaptiveTimeout);
+        setValue("network/advanced/connectSweep", connectSweep);
+        setValue("network/advanced/connectTimeout", connectTimeout);
+        setValue("network/advanced/resumeScans", resumeScans);
+        setValue("network/advanced/useHostCache", useHostCache);
+        setValue("network/advanced/liveTtl", liveTtl);
+        setValue("network/advanced/refusedTtl", refusedTtl);
+        setValue("network/advanced/deadTtl", deadTtl);
+        setValue("network/advanced/benchmark", benchmark);
+        setValue("network/advanced/benchmarkSamples", benchmarkSamples);
+        setValue("network/advanced/judgeUrl", judgeUrl);
         setValue("network/advanced/maxThreads", maxThreads);
+        setValue("network/advanced/minThreads", minThreads);
+        setValue("network/advanced/adaptiveConcurrency", adaptiveConcurrency);
+        setValue("network/advanced/rateLimit", rateLimit);
+        setValue("network/advanced/rateBurst", rateBurst);
+        setValue("network/advanced/workerThreads", workerThreads);
         setValue("network/advanced/requestType", int(requestType));
         setValue("network/advanced/requestUrl", requestUrl);
+        setValue("network/advanced/engine", int(engine));
+        // Output
+        setValue("output/file", outputFile);
+        setValue("output/format", int(outputFormat));
         // Preferences
         setValue("preferences/style/theme", theme);
     } else {
         // Basic
         getInitialAddress();
         getFinalAddress();
-        getPort();
+        getTargets();
+        getTargetsFile();
+        getPorts();
 
         // Advanced
         getTimeout();
+        getMinTimeout();
+        getAdaptiveTimeout();
+        getConnectSweep();
+        getConnectTimeout();
+        getResumeScans();
+        getUseHostCache();
+        getLiveTtl();
+        getRefusedTtl();
+        getDeadTtl();
+        getBenchmark();
+        getBenchmarkSamples();
+        getJudgeUrl();
         getMaxThreads();
+        getMinThreads();
+        getAdaptiveConcurrency();
+        getRateLimit();
+        getRateBurst();
+        getWorkerThreads();
         getRequestType();
         getRequestUrl();
+        getEngine();
+
+        // Output
+        getOutputFile();
+        getOutputFormat();
 
         // Preferences
         getTheme();
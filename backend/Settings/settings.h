@@ -18,12 +18,35 @@ class Settings : public QSettings
     // Network Basics
     Q_PROPERTY(QString initialAddress READ getInitialAddress WRITE setInitialAddress NOTIFY initialAddressChanged)
     Q_PROPERTY(QString finalAddress READ getFinalAddress WRITE setFinalAddress NOTIFY finalAddressChanged)
-    Q_PROPERTY(int port READ getPort WRITE setPort NOTIFY portChanged)
+    Q_PROPERTY(QString targets READ getTargets WRITE setTargets NOTIFY targetsChanged)
+    Q_PROPERTY(QString targetsFile READ getTargetsFile WRITE setTargetsFile NOTIFY targetsFileChanged)
+    Q_PROPERTY(QString ports READ getPorts WRITE setPorts NOTIFY portsChanged)
     // Network Advanced
     Q_PROPERTY(int timeout READ getTimeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(int minTimeout READ getMinTimeout WRITE setMinTimeout NOTIFY minTimeoutChanged)
+    Q_PROPERTY(bool adaptiveTimeout READ getAdaptiveTimeout WRITE setAdaptiveTimeout NOTIFY adaptiveTimeoutChanged)
+    Q_PROPERTY(bool connectSweep READ getConnectSweep WRITE setConnectSweep NOTIFY connectSweepChanged)
+    Q_PROPERTY(int connectTimeout READ getConnectTimeout WRITE setConnectTimeout NOTIFY connectTimeoutChanged)
+    Q_PROPERTY(bool resumeScans READ getResumeScans WRITE setResumeScans NOTIFY resumeScansChanged)
+    Q_PROPERTY(bool useHostCache READ getUseHostCache WRITE setUseHostCache NOTIFY useHostCacheChanged)
+    Q_PROPERTY(int liveTtl READ getLiveTtl WRITE setLiveTtl NOTIFY liveTtlChanged)
+    Q_PROPERTY(int refusedTtl READ getRefusedTtl WRITE setRefusedTtl NOTIFY refusedTtlChanged)
+    Q_PROPERTY(int deadTtl READ getDeadTtl WRITE setDeadTtl NOTIFY deadTtlChanged)
+    Q_PROPERTY(bool benchmark READ getBenchmark WRITE setBenchmark NOTIFY benchmarkChanged)
+    Q_PROPERTY(int benchmarkSamples READ getBenchmarkSamples WRITE setBenchmarkSamples NOTIFY benchmarkSamplesChanged)
+    Q_PROPERTY(QString judgeUrl READ getJudgeUrl WRITE setJudgeUrl NOTIFY judgeUrlChanged)
     Q_PROPERTY(unsigned maxThreads READ getMaxThreads WRITE setMaxThreads NOTIFY maxThreadsChanged)
+    Q_PROPERTY(unsigned minThreads READ getMinThreads WRITE setMinThreads NOTIFY minThreadsChanged)
+    Q_PROPERTY(bool adaptiveConcurrency READ getAdaptiveConcurrency WRITE setAdaptiveConcurrency NOTIFY adaptiveConcurrencyChanged)
+    Q_PROPERTY(int rateLimit READ getRateLimit WRITE setRateLimit NOTIFY rateLimitChanged)
+    Q_PROPERTY(int rateBurst READ getRateBurst WRITE setRateBurst NOTIFY rateBurstChanged)
+    Q_PROPERTY(int workerThreads READ getWorkerThreads WRITE setWorkerThreads NOTIFY workerThreadsChanged)
     Q_PROPERTY(ThreadedFinder::RequestType requestType READ getRequestType WRITE setRequestType NOTIFY requestTypeChanged)
     Q_PROPERTY(QString requestUrl READ getRequestUrl WRITE setRequestUrl NOTIFY requestUrlChanged)
+    Q_PROPERTY(ThreadedFinder::Engine engine READ getEngine WRITE setEngine NOTIFY engineChanged)
+    // Output
+    Q_PROPERTY(QString outputFile READ getOutputFile WRITE setOutputFile NOTIFY outputFileChanged)
+    Q_PROPERTY(ThreadedFinder::OutputFormat outputFormat READ getOutputFormat WRITE setOutputFormat NOTIFY outputFormatChanged)
     // Preferences
     Q_PROPERTY(int theme READ getTheme WRITE setTheme NOTIFY themeChanged)
 
@@ -49,22 +72,89 @@ public:
     QString getFinalAddress();
     void setFinalAddress(const QString &ip);
 
-    unsigned short getPort();
-    void setPort(unsigned short p);
+    QString getTargets();
+    void setTargets(const QString &targetList);
+
+    QString getTargetsFile();
+    void setTargetsFile(const QString &fileName);
+
+    QString getPorts();
+    void setPorts(const QString &portList);
 
     // Advanced
     int getTimeout();
     void setTimeout(int t);
 
+    int getMinTimeout();
+    void setMinTimeout(int t);
+
+    bool getAdaptiveTimeout();
+    void setAdaptiveTimeout(bool enabled);
+
+    bool getConnectSweep();
+    void setConnectSweep(bool enabled);
+
+    int getConnectTimeout();
+    void setConnectTimeout(int t);
+
+    bool getResumeScans();
+    void setResumeScans(bool enabled);
+
+    bool getUseHostCache();
+    void setUseHostCache(bool enabled);
+
+    int getLiveTtl();
+    void setLiveTtl(int minutes);
+
+    int getRefusedTtl();
+    void setRefusedTtl(int minutes);
+
+    int getDeadTtl();
+    void setDeadTtl(int minutes);
+
+    bool getBenchmark();
+    void setBenchmark(bool enabled);
+
+    int getBenchmarkSamples();
+    void setBenchmarkSamples(int samples);
+
+    QString getJudgeUrl();
+    void setJudgeUrl(const QString &url);
+
     unsigned int getMaxThreads();
     void setMaxThreads(unsigned int n);
 
+    unsigned int getMinThreads();
+    void setMinThreads(unsigned int n);
+
+    bool getAdaptiveConcurrency();
+    void setAdaptiveConcurrency(bool enabled);
+
+    int getRateLimit();
+    void setRateLimit(int n);
+
+    int getRateBurst();
+    void setRateBurst(int n);
+
+    int getWorkerThreads();
+    void setWorkerThreads(int n);
+
     ThreadedFinder::RequestType getRequestType();
     void setRequestType(const ThreadedFinder::RequestType &type);
 
     QString getRequestUrl();
     void setRequestUrl(const QString &url);
 
+    ThreadedFinder::Engine getEngine();
+    void setEngine(const ThreadedFinder::Engine &newEngine);
+
+    // Output
+    QString getOutputFile();
+    void setOutputFile(const QString &fileName);
+
+    ThreadedFinder::OutputFormat getOutputFormat();
+    void setOutputFormat(const ThreadedFinder::OutputFormat &format);
+
     // Preferences
     int getTheme();
     void setTheme(int newTheme);
@@ -81,12 +171,35 @@ signals:
     // Basics
     void initialAddressChanged(const QString &address);
     void finalAddressChanged(const QString &address);
-    void portChanged(unsigned short newPort);
+    void targetsChanged(const QString &newTargets);
+    void targetsFileChanged(const QString &newTargetsFile);
+    void portsChanged(const QString &newPorts);
     // Advanced
     void timeoutChanged(int newTimeout);
+    void minTimeoutChanged(int newMinTimeout);
+    void adaptiveTimeoutChanged(bool enabled);
+    void connectSweepChanged(bool enabled);
+    void connectTimeoutChanged(int newTimeout);
+    void resumeScansChanged(bool enabled);
+    void useHostCacheChanged(bool enabled);
+    void liveTtlChanged(int minutes);
+    void refusedTtlChanged(int minutes);
+    void deadTtlChanged(int minutes);
+    void benchmarkChanged(bool enabled);
+    void benchmarkSamplesChanged(int samples);
+    void judgeUrlChanged(const QString &newJudgeUrl);
     void maxThreadsChanged(unsigned int newMaxThreads);
+    void minThreadsChanged(unsigned int newMinThreads);
+    void adaptiveConcurrencyChanged(bool enabled);
+    void rateLimitChanged(int newRateLimit);
+    void rateBurstChanged(int newRateBurst);
+    void workerThreadsChanged(int newWorkerThreads);
     void requestTypeChanged(const ThreadedFinder::RequestType &newRequestType);
     void requestUrlChanged(const QString &newUrl);
+    void engineChanged(const ThreadedFinder::Engine &newEngine);
+    // Output
+    void outputFileChanged(const QString &newOutputFile);
+    void outputFormatChanged(const ThreadedFinder::OutputFormat &newOutputFormat);
     // Preferences
     void themeChanged(int newTheme);
 
@@ -105,13 +218,36 @@ private:
 
     // Basics
     QString initialAddress, finalAddress;
-    unsigned short port = 0;
+    QString targets, targetsFile;
+    QString ports;
 
     // Advanced
     int timeout = 1000;
+    int minTimeout = 250;
+    bool adaptiveTimeout = true;
+    bool connectSweep = true;
+    int connectTimeout = 300;
+    bool resumeScans = true;
+    bool useHostCache = true;
+    int liveTtl = 24 * 60; // minutes
+    int refusedTtl = 6 * 60;
+    int deadTtl = 60;
+    bool benchmark = false;
+    int benchmarkSamples = 3;
+    QString judgeUrl = "http://azenv.net/";
     unsigned int maxThreads = 300;
+    unsigned int minThreads = 50;
+    bool adaptiveConcurrency = true;
+    int rateLimit = 0;
+    int rateBurst = 100;
+    int workerThreads = QThread::idealThreadCount();
     ThreadedFinder::RequestType requestType = ThreadedFinder::HTTP;
     QString requestUrl = "google.com";
+    ThreadedFinder::Engine engine = ThreadedFinder::QtNetwork;
+
+    // Output
+    QString outputFile;
+    ThreadedFinder::OutputFormat outputFormat = ThreadedFinder::NDJSON;
 
     // Preferences
     int theme = System;
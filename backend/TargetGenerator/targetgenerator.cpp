@@ -0,0 +1,58 @@
+#include "targetgenerator.h"
+#include <limits>
+
+// Large IPv6 sets times the ports don't fit in 64 bits, they count as the maximum
+static quint64 saturatedMultiply(quint64 a, quint64 b)
+{
+    return b != 0 && a > std::numeric_limits<quint64>::max() / b ? std::numeric_limits<quint64>::max() : a * b;
+}
+
+TargetGenerator::TargetGenerator(const AddressSet &addressSet, const PortSet &portSet)
+{
+    addresses = addressSet;
+    ports = portSet;
+}
+
+bool TargetGenerator::hasNext() const
+{
+    return !ports.isEmpty() && (portIndex > 0 || addresses.hasNext());
+}
+
+ScanTarget TargetGenerator::next()
+{
+    if (portIndex == 0) {
+        address = addresses.next();
+    }
+    const ScanTarget target = { address, ports.at(portIndex) };
+    portIndex = (portIndex + 1) % ports.count();
+    return target;
+}
+
+void TargetGenerator::seek(quint64 position)
+{
+    if (ports.isEmpty()) {
+        return;
+    }
+    addresses.seek(position / quint64(ports.count()));
+    portIndex = int(position % quint64(ports.count()));
+    if (portIndex > 0) {
+        address = addresses.next();
+    }
+}
+
+bool TargetGenerator::contains(const ScanTarget &target) const
+{
+    return ports.contains(target.port) && addresses.contains(target.address);
+}
+
+quint64 TargetGenerator::size() const
+{
+    return saturatedMultiply(addresses.size(), quint64(ports.count()));
+}
+
+quint64 TargetGenerator::remaining() const
+{
+    const quint64 portsLeft = portIndex > 0 ? quint64(ports.count() - portIndex) : 0;
+    const quint64 addressesLeft = saturatedMultiply(addresses.remaining(), quint64(ports.count()));
+    return addressesLeft > std::numeric_limits<quint64>::max() - portsLeft ? std::numeric_limits<quint64>::max() : addressesLeft + portsLeft;
+}
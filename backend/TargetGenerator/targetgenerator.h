@@ -0,0 +1,34 @@
+#ifndef TARGETGENERATOR_H
+#define TARGETGENERATOR_H
+
+#include "../AddressSet/addressset.h"
+#include "../PortSet/portset.h"
+
+struct ScanTarget {
+    IpAddress address;
+    unsigned short port;
+};
+
+// Lazy product of the addresses and the ports to scan: every port of an
+// address is produced before moving on to the next address.
+class TargetGenerator
+{
+public:
+    TargetGenerator(const AddressSet &addressSet = AddressSet(), const PortSet &portSet = PortSet());
+
+    bool hasNext() const;
+    ScanTarget next();
+    void seek(quint64 position);
+    bool contains(const ScanTarget &target) const;
+
+    quint64 size() const;
+    quint64 remaining() const;
+
+private:
+    AddressSet addresses;
+    PortSet ports;
+    IpAddress address;
+    int portIndex = 0;
+};
+
+#endif // TARGETGENERATOR_H
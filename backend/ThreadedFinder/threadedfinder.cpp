@@ -1,175 +1,606 @@
 #include "threadedfinder.h"
+#include "../ProtocolDetector/protocoldetector.h"
+#ifdef Q_OS_LINUX
+#include "../EpollProbeEngine/epollprobeengine.h"
+#endif
 #include <QDebug>
 #include <QEventLoop>
+#include <QScopedPointer>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
+#include <QTimer>
+#include <QCryptographicHash>
+#include <limits>
 
 //#define DEBUG
 
+static const int CheckpointInterval = 5000;
+// Sequences of the live proxies checked ahead of the scan, outside of its order
+static const quint64 PrioritySequence = quint64(1) << 63;
+// Targets skipped per dispatch before yielding to the event loop
+static const int MaximumSkips = 65536;
+static const int StatisticsInterval = 1000;
+
 ThreadedFinder::ThreadedFinder(QObject *parent)
     : QThread (parent)
 {
+    results.setFilter(filterSet());
+    reportModel = new ReportModel(&results, 100, this);
+
     connect(this, &ThreadedFinder::singleCheckFinished, [=] {
-        // Exit the finder when the list gets empty
-        if (connectedCheckers.isEmpty()) {
-            setProgress(0);
-            emit scanFinished();
-            quit();
-            return;
-        }
+        continueScan();
+    });
 
-        if (runningCheckers == 0) {
-            launchNetworkCheckers();
-        }
+    // The timer lives in the thread of the finder object, the views'
+    timerStatistics.setInterval(StatisticsInterval);
+    connect(&timerStatistics, &QTimer::timeout, this, &ThreadedFinder::statisticsChanged);
+    connect(this, &QThread::started, &timerStatistics, [=] {
+        timerStatistics.start();
+    });
+    connect(this, &QThread::finished, &timerStatistics, [=] {
+        timerStatistics.stop();
+        emit statisticsChanged();
     });
 }
 
 ThreadedFinder::~ThreadedFinder()
 {
+    if (isRunning()) {
+        stop();
+        wait();
+    }
     clean();
 }
 
+void ThreadedFinder::stop()
+{
+    // The scan ends as soon as the finder loop returns, checkpointing what's done
+    quit();
+}
+
 void ThreadedFinder::clean()
 {
     addressesToScan = 0;
-    for (auto x : connectedCheckers) {
-        x->stop();
-        x->deleteLater();
+    if (probeEngine) {
+        probeEngine->stop();
+    }
+    if (proxyBenchmark) {
+        proxyBenchmark->stop();
     }
 
+    // Replies of the checks still in flight will be ignored
     runningCheckers = 0;
-    connectedCheckers.clear();
+    firstPendingSequence = nextSequence;
+    pendingChecks.clear();
+    priorityTargets.clear();
+    prioritizedTargets.clear();
+    priorityChecks.clear();
+    completedPriorityTargets.clear();
+    skippedTargets = 0;
 
-    for (auto x : fullReport) {
-        x->deleteLater();
-    }
-    fullReport.clear();
-    report.clear();
+    results.clear();
 
     setScaning(false);
     setProgress(0);
-    emit reportChanged(report);
+    reportModel->scheduleUpdate();
 }
 
 void ThreadedFinder::updateProgress()
 {
-    if (settingCheckers) {
-        setProgressPartial(unsigned(connectedCheckers.count()));
-    } else {
-        setProgressPartial(progressTotal - addressesToScan);
-    }
-    setProgress(double(progressPartial)/progressTotal);
+    setProgressPartial(progressTotal - double(addressesToScan));
+    setProgress(progressPartial/progressTotal);
 }
 
 bool ThreadedFinder::addressesAreInverted()
 {
-    return finalAddress.toIPv4Address() < initialAddress.toIPv4Address();
+    return IpAddress::fromHostAddress(finalAddress) < IpAddress::fromHostAddress(initialAddress);
 }
 
 void ThreadedFinder::run()
 {
     setRunning(true);
     clean();
+    clock.start();
+    scanBaseSequence = nextSequence;
+    // The adaptive window starts at the minimum and is kept within the user bounds
+    const int maximumConcurrency = int(qMin(maxThreads, unsigned(std::numeric_limits<int>::max())));
+    if (adaptiveConcurrency) {
+        concurrencyController.setBounds(int(qMin(minThreads, maxThreads)), maximumConcurrency);
+        concurrencyController.reset(clock.elapsed());
+        setConcurrency(concurrencyController.getWindow());
+    } else {
+        setConcurrency(maximumConcurrency);
+    }
+
+    // The engines of the previous scan are gone, and their shards with them
+    scanStatistics.clear();
+    statisticsShard = scanStatistics.createShard();
+
+    // The engine lives in this thread, so the replies are handled here too
+    QScopedPointer<ProbeEngine> engineInstance(createProbeEngine());
+    engineInstance->setStatistics(&scanStatistics);
+    connect(engineInstance.data(), &ProbeEngine::replied, engineInstance.data(), [=](quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols) {
+        onReplied(sequence, address, port, error, reason, protocols);
+    });
+    probeEngine = engineInstance.data();
+
+    // Hits stay in flight until benchmarked, so they're written and checkpointed with their measures
+    QScopedPointer<ProxyBenchmark> benchmarkInstance;
+    if (benchmark) {
+        const QString scheme = requestTypeToProtocolString[requestType];
+        benchmarkInstance.reset(new ProxyBenchmark(QUrl(scheme + "://" + requestUrl), QUrl(judgeUrl), benchmarkSamples, timeout));
+        connect(benchmarkInstance.data(), &ProxyBenchmark::finished, benchmarkInstance.data(), [=](quint64 sequence, const ScanResult &result) {
+            completeCheck(sequence, result);
+        });
+    }
+    proxyBenchmark = benchmarkInstance.data();
+
     fillQueue();
-    setupNetworkCheckers();
+    resumeFromCheckpoint();
+    loadHostCache();
+
+    // Every reply is appended to the output file while the scan runs
+    QScopedPointer<ResultWriter> writerInstance;
+    if (!outputFile.isEmpty()) {
+        writerInstance.reset(new ResultWriter(outputFile, ResultSink::create(ResultSink::Format(outputFormat))));
+        connect(writerInstance.data(), &ResultWriter::failed, writerInstance.data(), [=](const QString &reason) {
+            qWarning() << "Warning: Unable to write the results to" << outputFile << ':' << reason << endl;
+        }, Qt::DirectConnection);
+        writerInstance->start();
+    }
+    resultWriter = writerInstance.data();
+
+    QTimer timerCheckpoint;
+    timerCheckpoint.setInterval(CheckpointInterval);
+    connect(&timerCheckpoint, &QTimer::timeout, &timerCheckpoint, [=] {
+        saveCheckpoint();
+    });
+    if (!checkpointFile.isEmpty()) {
+        timerCheckpoint.start();
+    }
+
+    // Dispatching held back by the rate limit, or after many skipped targets, resumes from here
+    QTimer timerDispatch;
+    timerDispatch.setSingleShot(true);
+    timerDispatch.setTimerType(Qt::PreciseTimer);
+    connect(&timerDispatch, &QTimer::timeout, &timerDispatch, [=] {
+        continueScan();
+    });
+    rateLimiter.configure(rateLimit, rateBurst);
+    rateLimiter.reset(clock.nsecsElapsed());
+    dispatchTimer = &timerDispatch;
+
+    // The configured timeout is the longest one, only answers shorten it
+    rttEstimator.setBounds(qMin(minTimeout, timeout), timeout);
+    rttEstimator.clear();
+
     updateProgress();
     setScaning(true);
     launchNetworkCheckers();
-    exec();
-    setStatus(FinishedAndReady);
+    if (runningCheckers > 0 || timerDispatch.isActive()) {
+        exec();
+    }
+    timerCheckpoint.stop();
+    timerDispatch.stop();
+    dispatchTimer = nullptr;
+
+    // An interrupted scan leaves its checkpoint behind, a completed one removes it
+    const bool completed = scanCompleted();
+    if (!completed) {
+        saveCheckpoint();
+    }
+    saveHostCache();
+    probeEngine = nullptr;
+    statisticsShard = nullptr;
+    proxyBenchmark = nullptr;
+    resultWriter = nullptr;
+    writerInstance.reset();
+    if (completed && !checkpointFile.isEmpty()) {
+        QFile::remove(checkpointFile);
+    }
+    setStatus(completed ? FinishedAndReady : AbortedAndReady);
     setScaning(false);
     setRunning(false);
 }
 
+ProbeEngine *ThreadedFinder::createProbeEngine() const
+{
+    // The request is the same for every check, so it's built once
+    const QString scheme = requestTypeToProtocolString[requestType];
+    // Without the sweep the connection is part of the proxy check
+    const int tcpConnectTimeout = connectSweep ? connectTimeout : 0;
+#ifdef Q_OS_LINUX
+    // Only the native engine sees the raw answers the protocols are detected from
+    if (requestType == Detect) {
+        return new EpollProbeEngine(ProtocolDetector(requestUrl), timeout, tcpConnectTimeout, workerThreads);
+    }
+    if (engine == Native) {
+        return new EpollProbeEngine(EpollProbeEngine::proxyRequest(scheme, requestUrl), timeout, tcpConnectTimeout, workerThreads);
+    }
+#else
+    if (requestType == Detect) {
+        qWarning() << "Warning: Protocol detection is only available on Linux, checking HTTP instead" << endl;
+    }
+    if (engine == Native) {
+        qWarning() << "Warning: The native engine is only available on Linux, using Qt Network instead" << endl;
+    }
+#endif
+
+    QNetworkRequest request(QUrl(scheme + "://" + requestUrl));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "Requester");
+    return new ProxyCheckerPool(request, requestTypeToProxyType[requestType], timeout, tcpConnectTimeout, workerThreads);
+}
+
 void ThreadedFinder::fillQueue()
 {
     setStatus(GettingAddresses);
     setGettingAddresses(true);
-    const unsigned int initialIP = initialAddress.toIPv4Address();
-    const unsigned int finalIP = finalAddress.toIPv4Address();
-    launchIndex = initialIP;
-    addressesToScan = finalIP - initialIP;
-    setProgressTotal(addressesToScan);
+
+    // The range and the target list are merged, so no address is checked twice
+    AddressSet addresses;
+    if (validInitialAddress && validFinalAddress) {
+        addresses.insert(IpAddress::fromHostAddress(initialAddress), IpAddress::fromHostAddress(finalAddress));
+    }
+    addresses.insertList(targets.toLatin1());
+    if (!targetsFile.isEmpty() && !addresses.insertFile(targetsFile)) {
+        qWarning() << "Warning: Unable to read the targets file" << targetsFile << endl;
+    }
+    addresses.normalize();
+
+    targetGenerator = TargetGenerator(addresses, portSet);
+    addressesToScan = targetGenerator.size();
+    setProgressTotal(double(addressesToScan));
     setGettingAddresses(false);
 }
 
-void ThreadedFinder::setupNetworkCheckers()
+void ThreadedFinder::launchNetworkCheckers()
 {
-    setStatus(SettingCheckers);
-    setSettingCheckers(true);
-    const unsigned int initialIP = initialAddress.toIPv4Address();
-    const unsigned int finalIP = finalAddress.toIPv4Address();
-    for (unsigned int i = initialIP; i <= finalIP; ++i) {
-        ProxyCheckerThreadWrapper *proxyChecker = new ProxyCheckerThreadWrapper(QNetworkProxy(requestTypeToProxyType[requestType], QHostAddress(i).toString(), port), timeout);
-        connectedCheckers.append(proxyChecker);
-        updateProgress();
-        connect(proxyChecker, &ProxyCheckerThreadWrapper::replied, this, &ThreadedFinder::onReplied);
+    setStatus(Scaning);
+    const qint64 cacheTime = QDateTime::currentSecsSinceEpoch();
+    int skipped = 0;
+    while (runningCheckers < unsigned(concurrency) && (!priorityTargets.isEmpty() || targetGenerator.hasNext())) {
+        const quint64 sequence = nextSequence;
+        // Checked before the scan was interrupted
+        const bool resumed = priorityTargets.isEmpty() && !resumedTargets.isEmpty()
+                && resumedTargets.remove(sequence - scanBaseSequence);
+        const qint64 now = clock.nsecsElapsed();
+        if (!resumed && !rateLimiter.tryAcquire(now)) {
+            if (dispatchTimer && !dispatchTimer->isActive()) {
+                dispatchTimer->start(int(qMax(qint64(1), (rateLimiter.nextTokenIn(now) + 999999) / 1000000)));
+            }
+            break;
+        }
 
-        // Remove the deleted proxy thread from the containers
-        connect(proxyChecker, &ProxyCheckerThreadWrapper::destroyed, [=](QObject *obj) {
-            connectedCheckers.removeOne(static_cast<ProxyCheckerThreadWrapper*>(obj));
-            runningCheckers--;
+        // Live proxies known from previous scans go first
+        if (!priorityTargets.isEmpty()) {
+            const ScanTarget target = priorityTargets.dequeue();
+            const quint64 prioritySequence = PrioritySequence | nextPrioritySequence++;
+            priorityChecks.insert(prioritySequence, now);
+            runningCheckers++;
+            probeEngine->start(prioritySequence, target.address, target.port, checkTimeout(target.address));
+            continue;
+        }
+
+        const ScanTarget target = targetGenerator.next();
+        nextSequence++;
+        if (resumed) {
+            pendingChecks.enqueue(-1);
+            continue;
+        }
+        // Checked ahead of the scan, or recently found dead or refusing
+        if ((!prioritizedTargets.isEmpty() && prioritizedTargets.contains(qMakePair(target.address, target.port)))
+                || (useHostCache && hostCache.isSkipped(target.address, target.port, int(requestType), cacheTime))) {
+            rateLimiter.refund();
+            pendingChecks.enqueue(-1);
             addressesToScan--;
-            updateProgress();
+            skippedTargets++;
+            if (++skipped == MaximumSkips) {
+                if (dispatchTimer) {
+                    dispatchTimer->start(0);
+                }
+                break;
+            }
+            continue;
+        }
+        pendingChecks.enqueue(now);
+        runningCheckers++;
+        probeEngine->start(sequence, target.address, target.port, checkTimeout(target.address));
+    }
+    releaseCompletedChecks();
+    if (skipped > 0) {
+        updateProgress();
+    }
+}
 
-            emit singleCheckFinished();
-        });
+void ThreadedFinder::continueScan()
+{
+    // Reuse the released slots right away
+    if (!priorityTargets.isEmpty() || targetGenerator.hasNext()) {
+        launchNetworkCheckers();
+    }
+
+    // Exit the finder when every address has been checked
+    if (scanCompleted()) {
+        setProgress(0);
+        emit scanFinished();
+        quit();
     }
-    setSettingCheckers(false);
 }
 
-void ThreadedFinder::launchNetworkCheckers()
+bool ThreadedFinder::scanCompleted() const
 {
-    setStatus(Scaning);
-    const unsigned int finalIP = finalAddress.toIPv4Address();
-    for (; launchIndex <= finalIP; ++launchIndex) {
-        if (addressesToScan == 0) {
-            quit();
+    return pendingChecks.isEmpty() && priorityChecks.isEmpty() && priorityTargets.isEmpty() && !targetGenerator.hasNext();
+}
+
+int ThreadedFinder::checkTimeout(const IpAddress &address) const
+{
+    return adaptiveTimeout ? rttEstimator.timeoutFor(address) : timeout;
+}
+
+void ThreadedFinder::loadHostCache()
+{
+    hostCache.clear();
+    if (!useHostCache || hostCacheFile.isEmpty()) {
+        return;
+    }
+    hostCache.setTtl(HostCache::Live, qint64(liveTtl) * 60);
+    hostCache.setTtl(HostCache::Refused, qint64(refusedTtl) * 60);
+    hostCache.setTtl(HostCache::Dead, qint64(deadTtl) * 60);
+    hostCache.load(hostCacheFile);
+
+    // Only the live proxies among the targets of this scan, not checked before a resume
+    for (const ScanTarget &target : hostCache.liveTargets(int(requestType), QDateTime::currentSecsSinceEpoch())) {
+        if (targetGenerator.contains(target) && !prioritizedTargets.contains(qMakePair(target.address, target.port))) {
+            priorityTargets.enqueue(target);
+            prioritizedTargets.insert(qMakePair(target.address, target.port));
         }
-        if (runningCheckers >= maxThreads) {
-            break;
+    }
+    if (!priorityTargets.isEmpty()) {
+        qInfo() << "Checking first" << priorityTargets.count() << "proxies found alive by previous scans";
+    }
+}
+
+void ThreadedFinder::saveHostCache()
+{
+    if (skippedTargets > 0) {
+        qInfo() << "Skipped" << skippedTargets << "targets known from previous scans";
+    }
+    if (useHostCache && !hostCacheFile.isEmpty() && !hostCache.save(hostCacheFile, QDateTime::currentSecsSinceEpoch())) {
+        qWarning() << "Warning: Unable to save the host cache" << hostCacheFile << endl;
+    }
+    hostCache.clear();
+}
+
+void ThreadedFinder::releaseCompletedChecks()
+{
+    while (!pendingChecks.isEmpty() && pendingChecks.head() < 0) {
+        pendingChecks.dequeue();
+        firstPendingSequence++;
+    }
+}
+
+QByteArray ThreadedFinder::scanFingerprint() const
+{
+    // Everything that changes the targets, their order or the meaning of the results
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (validInitialAddress && validFinalAddress) {
+        hash.addData(initialAddress.toString().toUtf8() + '-' + finalAddress.toString().toUtf8());
+    }
+    hash.addData('\n' + targets.toUtf8());
+    if (!targetsFile.isEmpty()) {
+        const QFileInfo info(targetsFile);
+        hash.addData('\n' + info.absoluteFilePath().toUtf8() + ' ' + QByteArray::number(info.size())
+                     + ' ' + QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    hash.addData('\n' + portSet.toString().toUtf8());
+    hash.addData('\n' + QByteArray::number(int(requestType)) + ' ' + requestUrl.toUtf8());
+    return hash.result();
+}
+
+void ThreadedFinder::resumeFromCheckpoint()
+{
+    fingerprint = scanFingerprint();
+    resumedTargets.clear();
+    if (!resumeScans || checkpointFile.isEmpty()) {
+        return;
+    }
+
+    ScanCheckpoint checkpoint;
+    if (!checkpoint.load(checkpointFile) || checkpoint.fingerprint != fingerprint || checkpoint.watermark > targetGenerator.size()) {
+        return;
+    }
+
+    // Results written after the checkpoint belong to checks that run again
+    if (!outputFile.isEmpty() && checkpoint.resultsOffset >= 0 && QFileInfo(outputFile).size() > checkpoint.resultsOffset) {
+        QFile::resize(outputFile, checkpoint.resultsOffset);
+    }
+
+    targetGenerator.seek(checkpoint.watermark);
+    nextSequence += checkpoint.watermark;
+    firstPendingSequence = nextSequence;
+    for (quint64 target : checkpoint.completed) {
+        if (target >= checkpoint.watermark && target < targetGenerator.size()) {
+            resumedTargets.insert(target);
         }
-        for (int j = 0; j < connectedCheckers.count(); ++j) {
-            ProxyCheckerThreadWrapper *p = connectedCheckers[j];
-            if (p->getHostName() == QHostAddress(launchIndex).toString()) {
-                runningCheckers++;
-                QNetworkRequest request(QUrl(requestTypeToProtocolString[requestType] + "://" + requestUrl));
-                request.setHeader(QNetworkRequest::UserAgentHeader, "Requester");
-                p->start(request);
-                break; // go to the external loop
-            }
+    }
+    // Their results are in the file already, so the scan skips them as if just checked
+    for (const ScanTarget &target : checkpoint.prioritized) {
+        if (targetGenerator.contains(target)) {
+            completedPriorityTargets.append(target);
+            prioritizedTargets.insert(qMakePair(target.address, target.port));
+        }
+    }
+    addressesToScan = targetGenerator.size() - checkpoint.watermark - quint64(resumedTargets.count());
+    qInfo() << "Resuming the scan after" << checkpoint.watermark + quint64(resumedTargets.count()) << "checked targets";
+}
+
+ScanCheckpoint ThreadedFinder::checkpoint() const
+{
+    ScanCheckpoint state;
+    state.fingerprint = fingerprint;
+    state.watermark = firstPendingSequence - scanBaseSequence;
+    for (int i = 0; i < pendingChecks.count(); ++i) {
+        if (pendingChecks[i] < 0) {
+            state.completed.append(state.watermark + quint64(i));
+        }
+    }
+    // Resumed targets not reached yet are still done
+    for (quint64 target : resumedTargets) {
+        state.completed.append(target);
+    }
+    state.prioritized = completedPriorityTargets;
+    return state;
+}
+
+void ThreadedFinder::saveCheckpoint()
+{
+    if (checkpointFile.isEmpty()) {
+        return;
+    }
+    if (resultWriter) {
+        // Saved by the writer once the results before it are in the file
+        if (!resultWriter->checkpoint(checkpoint(), checkpointFile)) {
+            qWarning() << "Warning: Unable to save the checkpoint" << checkpointFile << "after a write failure" << endl;
         }
+    } else if (!checkpoint().save(checkpointFile)) {
+        qWarning() << "Warning: Unable to save the checkpoint" << checkpointFile << endl;
     }
 }
 
-void ThreadedFinder::onReplied(QNetworkReply *reply, ProxyCheckerThreadWrapper *obj)
+void ThreadedFinder::onReplied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols)
 {
-    emit replied(reply);
+    // Ignore the replies of checks that don't belong to the current scan
+    qint64 startedAt;
+    if (!pendingCheck(sequence, &startedAt)) {
+        return;
+    }
+    const quint32 latency = quint32(qMin((clock.nsecsElapsed() - startedAt) / 1000, qint64(std::numeric_limits<quint32>::max())));
+    statisticsShard->totalTime.record(latency);
+    statisticsShard->recordOutcome(error);
 
-    // Add proxy info to the report
-    QNetworkProxy proxy = reply->manager()->proxy();
-    //int httpCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    int httpCode = reply->error();
-    //QString httpReason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString();
-    QString httpReason = reply->errorString();
-    ProxyInfo *info = new ProxyInfo(proxy.hostName(), proxy.port(), httpCode, httpReason);
+    const ConcurrencyController::Outcome outcome = ConcurrencyController::outcomeFromError(error);
+    if (adaptiveConcurrency && concurrencyController.onCompleted(outcome, clock.elapsed())) {
+        setConcurrency(concurrencyController.getWindow());
+    }
+    if (RttEstimator::isProxyAnswer(error)) {
+        rttEstimator.addSample(address, latency);
+    }
+
+    ScanResult result = { address, port, error, reason, QDateTime::currentMSecsSinceEpoch(), latency, quint8(protocols), BenchmarkResult() };
 
 #ifdef DEBUG
-    qDebug() << proxy.hostName() + ':' + QString::number(proxy.port()) << httpCode << "(HTTP: " + QString::number(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()) +", " + reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString() + ")" << httpReason;
+    qDebug() << address.toString() + ':' + QString::number(port) << error << reason << latency;
 #endif
-    fullReport.append(info);
-    addInfoToReportUsingFilters(info);
-
-    // Schedule the deletion of the proxy thread
-    obj->deleteLater();
+    if (proxyBenchmark && error == QNetworkReply::NoError) {
+        const QNetworkProxy::ProxyType type = benchmarkProxyType(protocols);
+        if (type != QNetworkProxy::NoProxy) {
+            proxyBenchmark->start(sequence, result, type);
+            return;
+        }
+    }
+    completeCheck(sequence, result);
 }
 
-void ThreadedFinder::addInfoToReportUsingFilters(ProxyInfo *info)
+bool ThreadedFinder::pendingCheck(quint64 sequence, qint64 *startedAt) const
 {
-    for (auto code : filteredCodes) {
-        if (static_cast<ProxyInfo*>(info)->getHttpStatusCode() == code) {
-            report.append(info);
-            emit reportChanged(report);
-            break;
+    qint64 dispatchedAt;
+    if (sequence & PrioritySequence) {
+        const auto check = priorityChecks.constFind(sequence);
+        if (check == priorityChecks.constEnd()) {
+            return false;
+        }
+        dispatchedAt = check.value();
+    } else {
+        if (sequence < firstPendingSequence || sequence - firstPendingSequence >= quint64(pendingChecks.count())) {
+            return false;
         }
+        dispatchedAt = pendingChecks[int(sequence - firstPendingSequence)];
+    }
+    if (startedAt) {
+        *startedAt = dispatchedAt;
+    }
+    return dispatchedAt >= 0;
+}
+
+void ThreadedFinder::completeCheck(quint64 sequence, const ScanResult &result)
+{
+    if (!pendingCheck(sequence, nullptr)) {
+        return;
+    }
+    const bool prioritized = sequence & PrioritySequence;
+    if (prioritized) {
+        priorityChecks.remove(sequence);
+        completedPriorityTargets.append({ result.address, result.port });
+    } else {
+        pendingChecks[int(sequence - firstPendingSequence)] = -1;
+        releaseCompletedChecks();
+    }
+
+    // Add the result to the report
+    if (results.append(result)) {
+        reportModel->scheduleUpdate();
+    }
+    emit checkReplied(result.address, result.port, result.error, result.reason);
+    if (resultWriter) {
+        resultWriter->write(result);
+    }
+
+    // Cut short by an adaptive timeout below the configured one, a slow proxy may still be alive
+    const bool cutShort = adaptiveTimeout && result.error == QNetworkReply::OperationCanceledError
+            && quint64(result.latency) < quint64(timeout) * 1000;
+    HostCache::Outcome cached;
+    if (useHostCache && !cutShort && HostCache::outcomeFromError(result.error, &cached)) {
+        hostCache.record(result.address, result.port, int(requestType), cached, result.timestamp / 1000);
+    }
+
+    runningCheckers--;
+    // The checks made ahead of the scan are counted when the scan skips them
+    if (!prioritized) {
+        addressesToScan--;
+    }
+    updateProgress();
+
+    emit singleCheckFinished();
+}
+
+QNetworkProxy::ProxyType ThreadedFinder::benchmarkProxyType(int protocols) const
+{
+    if (requestType != Detect) {
+        return requestTypeToProxyType[requestType];
+    }
+    // Qt Network speaks neither SOCKS4 nor plain CONNECT to an HTTP URL
+    if (protocols & ProtocolDetector::HttpForward) {
+        return QNetworkProxy::HttpCachingProxy;
+    }
+    if (protocols & ProtocolDetector::Socks5) {
+        return QNetworkProxy::Socks5Proxy;
+    }
+    return QNetworkProxy::NoProxy;
+}
+
+QSet<int> ThreadedFinder::filterSet() const
+{
+    QSet<int> codes;
+    for (const auto &code : filteredCodes) {
+        codes.insert(code.toInt());
+    }
+    return codes;
+}
+
+int ThreadedFinder::getWorkerThreads() const
+{
+    return workerThreads;
+}
+
+void ThreadedFinder::setWorkerThreads(int value)
+{
+    if (value < 1) {
+        value = QThread::idealThreadCount();
+    }
+    if (workerThreads != value) {
+        workerThreads = value;
+        emit workerThreadsChanged(value);
     }
 }
 
@@ -186,12 +617,12 @@ void ThreadedFinder::setStatus(const Status &value)
     }
 }
 
-unsigned ThreadedFinder::getProgressPartial() const
+double ThreadedFinder::getProgressPartial() const
 {
     return progressPartial;
 }
 
-void ThreadedFinder::setProgressPartial(unsigned value)
+void ThreadedFinder::setProgressPartial(double value)
 {
     if (progressPartial != value) {
         progressPartial = value;
@@ -199,12 +630,12 @@ void ThreadedFinder::setProgressPartial(unsigned value)
     }
 }
 
-unsigned ThreadedFinder::getProgressTotal() const
+double ThreadedFinder::getProgressTotal() const
 {
     return progressTotal;
 }
 
-void ThreadedFinder::setProgressTotal(unsigned value)
+void ThreadedFinder::setProgressTotal(double value)
 {
     if (progressTotal != value) {
         progressTotal = value;
@@ -238,28 +669,54 @@ void ThreadedFinder::setRunning(bool value)
     }
 }
 
-bool ThreadedFinder::getSettingCheckers() const
+double ThreadedFinder::getProgress() const
+{
+    return progress;
+}
+
+void ThreadedFinder::setProgress(double value)
+{
+    progress = value;
+    emit progressChanged(value);
+}
+
+ThreadedFinder::Engine ThreadedFinder::getEngine() const
 {
-    return settingCheckers;
+    return engine;
 }
 
-void ThreadedFinder::setSettingCheckers(bool value)
+void ThreadedFinder::setEngine(const ThreadedFinder::Engine &value)
 {
-    if (settingCheckers != value) {
-        settingCheckers = value;
-        emit settingCheckersChanged(value);
+    if (engine != value) {
+        engine = value;
+        emit engineChanged(value);
     }
 }
 
-double ThreadedFinder::getProgress() const
+QString ThreadedFinder::getOutputFile() const
 {
-    return progress;
+    return outputFile;
 }
 
-void ThreadedFinder::setProgress(double value)
+void ThreadedFinder::setOutputFile(const QString &value)
 {
-    progress = value;
-    emit progressChanged(value);
+    if (outputFile != value) {
+        outputFile = value;
+        emit outputFileChanged(value);
+    }
+}
+
+ThreadedFinder::OutputFormat ThreadedFinder::getOutputFormat() const
+{
+    return outputFormat;
+}
+
+void ThreadedFinder::setOutputFormat(const ThreadedFinder::OutputFormat &value)
+{
+    if (outputFormat != value) {
+        outputFormat = value;
+        emit outputFormatChanged(value);
+    }
 }
 
 QString ThreadedFinder::getRequestUrl() const
@@ -301,6 +758,188 @@ void ThreadedFinder::setTimeout(int value)
     }
 }
 
+int ThreadedFinder::getMinTimeout() const
+{
+    return minTimeout;
+}
+
+void ThreadedFinder::setMinTimeout(int value)
+{
+    if (minTimeout != value) {
+        minTimeout = value;
+        emit minTimeoutChanged(value);
+    }
+}
+
+bool ThreadedFinder::getAdaptiveTimeout() const
+{
+    return adaptiveTimeout;
+}
+
+void ThreadedFinder::setAdaptiveTimeout(bool value)
+{
+    if (adaptiveTimeout != value) {
+        adaptiveTimeout = value;
+        emit adaptiveTimeoutChanged(value);
+    }
+}
+
+bool ThreadedFinder::getConnectSweep() const
+{
+    return connectSweep;
+}
+
+void ThreadedFinder::setConnectSweep(bool value)
+{
+    if (connectSweep != value) {
+        connectSweep = value;
+        emit connectSweepChanged(value);
+    }
+}
+
+bool ThreadedFinder::getResumeScans() const
+{
+    return resumeScans;
+}
+
+void ThreadedFinder::setResumeScans(bool value)
+{
+    if (resumeScans != value) {
+        resumeScans = value;
+        emit resumeScansChanged(value);
+    }
+}
+
+QString ThreadedFinder::getCheckpointFile() const
+{
+    return checkpointFile;
+}
+
+void ThreadedFinder::setCheckpointFile(const QString &value)
+{
+    if (checkpointFile != value) {
+        checkpointFile = value;
+        emit checkpointFileChanged(value);
+    }
+}
+
+bool ThreadedFinder::getUseHostCache() const
+{
+    return useHostCache;
+}
+
+void ThreadedFinder::setUseHostCache(bool value)
+{
+    if (useHostCache != value) {
+        useHostCache = value;
+        emit useHostCacheChanged(value);
+    }
+}
+
+QString ThreadedFinder::getHostCacheFile() const
+{
+    return hostCacheFile;
+}
+
+void ThreadedFinder::setHostCacheFile(const QString &value)
+{
+    if (hostCacheFile != value) {
+        hostCacheFile = value;
+        emit hostCacheFileChanged(value);
+    }
+}
+
+int ThreadedFinder::getLiveTtl() const
+{
+    return liveTtl;
+}
+
+void ThreadedFinder::setLiveTtl(int value)
+{
+    if (liveTtl != value) {
+        liveTtl = value;
+        emit liveTtlChanged(value);
+    }
+}
+
+int ThreadedFinder::getRefusedTtl() const
+{
+    return refusedTtl;
+}
+
+void ThreadedFinder::setRefusedTtl(int value)
+{
+    if (refusedTtl != value) {
+        refusedTtl = value;
+        emit refusedTtlChanged(value);
+    }
+}
+
+int ThreadedFinder::getDeadTtl() const
+{
+    return deadTtl;
+}
+
+void ThreadedFinder::setDeadTtl(int value)
+{
+    if (deadTtl != value) {
+        deadTtl = value;
+        emit deadTtlChanged(value);
+    }
+}
+
+bool ThreadedFinder::getBenchmark() const
+{
+    return benchmark;
+}
+
+void ThreadedFinder::setBenchmark(bool value)
+{
+    if (benchmark != value) {
+        benchmark = value;
+        emit benchmarkChanged(value);
+    }
+}
+
+int ThreadedFinder::getBenchmarkSamples() const
+{
+    return benchmarkSamples;
+}
+
+void ThreadedFinder::setBenchmarkSamples(int value)
+{
+    if (benchmarkSamples != value) {
+        benchmarkSamples = value;
+        emit benchmarkSamplesChanged(value);
+    }
+}
+
+QString ThreadedFinder::getJudgeUrl() const
+{
+    return judgeUrl;
+}
+
+void ThreadedFinder::setJudgeUrl(const QString &value)
+{
+    if (judgeUrl != value) {
+        judgeUrl = value;
+        emit judgeUrlChanged(value);
+    }
+}
+
+int ThreadedFinder::getConnectTimeout() const
+{
+    return connectTimeout;
+}
+
+void ThreadedFinder::setConnectTimeout(int value)
+{
+    if (connectTimeout != value) {
+        connectTimeout = value;
+        emit connectTimeoutChanged(value);
+    }
+}
+
 bool ThreadedFinder::getValidFinalAddress() const
 {
     return validFinalAddress;
@@ -314,6 +953,32 @@ void ThreadedFinder::setValidFinalAddress(bool value)
     }
 }
 
+bool ThreadedFinder::getValidTargets() const
+{
+    return validTargets;
+}
+
+void ThreadedFinder::setValidTargets(bool value)
+{
+    if (validTargets != value) {
+        validTargets = value;
+        emit validTargetsChanged(value);
+    }
+}
+
+bool ThreadedFinder::getValidPorts() const
+{
+    return validPorts;
+}
+
+void ThreadedFinder::setValidPorts(bool value)
+{
+    if (validPorts != value) {
+        validPorts = value;
+        emit validPortsChanged(value);
+    }
+}
+
 bool ThreadedFinder::getValidInitialAddress() const
 {
     return validInitialAddress;
@@ -329,11 +994,7 @@ void ThreadedFinder::setValidInitialAddress(bool value)
 
 void ThreadedFinder::updateReport()
 {
-    report.clear();
-    for (auto info : fullReport) {
-        addInfoToReportUsingFilters(static_cast<ProxyInfo*>(info));
-    }
-    emit reportChanged(report);
+    reportModel->refresh();
 }
 
 QVariantList ThreadedFinder::getFilteredCodes() const
@@ -345,6 +1006,8 @@ void ThreadedFinder::setFilteredCodes(const QVariantList &value)
 {
     if (filteredCodes != value) {
         filteredCodes = value;
+        results.setFilter(filterSet());
+        reportModel->scheduleUpdate();
         emit filteredCodesChanged(value);
     }
 }
@@ -390,21 +1053,75 @@ void ThreadedFinder::setInitialAddressString(const QString &value)
     }
 }
 
-QList<QObject *> ThreadedFinder::getReport() const
+ScanStatistics::Snapshot ThreadedFinder::statisticsSnapshot() const
+{
+    return scanStatistics.snapshot();
+}
+
+QVariantMap ThreadedFinder::getStatistics() const
+{
+    return scanStatistics.snapshot().toVariantMap();
+}
+
+ReportModel *ThreadedFinder::getReportModel() const
 {
-    return report;
+    return reportModel;
 }
 
-unsigned short ThreadedFinder::getPort() const
+const ResultStore *ThreadedFinder::getResults() const
 {
-    return port;
+    return &results;
 }
 
-void ThreadedFinder::setPort(unsigned short value)
+QString ThreadedFinder::getTargets() const
 {
-    if (port != value) {
-        port = value;
-        emit portChanged(value);
+    return targets;
+}
+
+void ThreadedFinder::setTargets(const QString &value)
+{
+    if (targets != value) {
+        targets = value;
+        updateValidTargets();
+        emit targetsChanged(value);
+    }
+}
+
+QString ThreadedFinder::getTargetsFile() const
+{
+    return targetsFile;
+}
+
+void ThreadedFinder::setTargetsFile(const QString &value)
+{
+    if (targetsFile != value) {
+        targetsFile = value;
+        updateValidTargets();
+        emit targetsFileChanged(value);
+    }
+}
+
+void ThreadedFinder::updateValidTargets()
+{
+    // The file can be huge, so it's only read when the scan starts
+    AddressSet addresses;
+    const bool validList = addresses.insertList(targets.toLatin1()) == 0;
+    const bool validFile = targetsFile.isEmpty() || QFileInfo(targetsFile).isReadable();
+    setValidTargets(validList && validFile);
+}
+
+QString ThreadedFinder::getPorts() const
+{
+    return ports;
+}
+
+void ThreadedFinder::setPorts(const QString &value)
+{
+    if (ports != value) {
+        ports = value;
+        portSet = PortSet(value);
+        setValidPorts(portSet.isValid());
+        emit portsChanged(value);
     }
 }
 
@@ -442,10 +1159,79 @@ void ThreadedFinder::setNumberOfThreads(unsigned int value)
     if (maxThreads != value) {
         if (value == 0) {
             qWarning() << "Warning: Number of threads:" << value << endl;
-        } else if (value > 500) {
-            qWarning() << "Warning: Number of threads:" << value << "> 500" << endl;
         }
         maxThreads = value;
         emit maxThreadsChanged(value);
     }
 }
+
+unsigned int ThreadedFinder::getMinThreads() const
+{
+    return minThreads;
+}
+
+void ThreadedFinder::setMinThreads(unsigned int value)
+{
+    if (minThreads != value) {
+        minThreads = value;
+        emit minThreadsChanged(value);
+    }
+}
+
+bool ThreadedFinder::getAdaptiveConcurrency() const
+{
+    return adaptiveConcurrency;
+}
+
+void ThreadedFinder::setAdaptiveConcurrency(bool value)
+{
+    if (adaptiveConcurrency != value) {
+        adaptiveConcurrency = value;
+        emit adaptiveConcurrencyChanged(value);
+    }
+}
+
+int ThreadedFinder::getRateLimit() const
+{
+    return rateLimit;
+}
+
+void ThreadedFinder::setRateLimit(int value)
+{
+    if (value < 0) {
+        value = 0;
+    }
+    if (rateLimit != value) {
+        rateLimit = value;
+        emit rateLimitChanged(value);
+    }
+}
+
+int ThreadedFinder::getRateBurst() const
+{
+    return rateBurst;
+}
+
+void ThreadedFinder::setRateBurst(int value)
+{
+    if (value < 1) {
+        value = 1;
+    }
+    if (rateBurst != value) {
+        rateBurst = value;
+        emit rateBurstChanged(value);
+    }
+}
+
+int ThreadedFinder::getConcurrency() const
+{
+    return concurrency;
+}
+
+void ThreadedFinder::setConcurrency(int value)
+{
+    if (concurrency != value) {
+        concurrency = value;
+        emit concurrencyChanged(value);
+    }
+}
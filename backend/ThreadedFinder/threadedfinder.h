@@ -1,10 +1,23 @@
 #ifndef THREADEDFINDER_H
 #define THREADEDFINDER_H
 
-#include "../ProxyCheckerThreadWrapper/proxycheckerthreadwrapper.h"
-#include "../ProxyInfo/proxyinfo.h"
+#include "../ProxyCheckerPool/proxycheckerpool.h"
+#include "../ConcurrencyController/concurrencycontroller.h"
+#include "../RateLimiter/ratelimiter.h"
+#include "../RttEstimator/rttestimator.h"
+#include "../HostCache/hostcache.h"
+#include "../ProxyBenchmark/proxybenchmark.h"
+#include "../ScanStatistics/scanstatistics.h"
+#include "../TargetGenerator/targetgenerator.h"
+#include "../ResultWriter/resultwriter.h"
+#include "../ResultStore/resultstore.h"
+#include "../models/ReportModel/reportmodel.h"
 #include <QThread>
 #include <QQueue>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QHash>
+#include <QTimer>
 
 class ThreadedFinder : public QThread
 {
@@ -12,49 +25,114 @@ class ThreadedFinder : public QThread
 
     Q_PROPERTY(QString initialAddress READ getInitialAddressString WRITE setInitialAddressString NOTIFY initialAddressStringChanged)
     Q_PROPERTY(QString finalAddress READ getFinalAddressString WRITE setFinalAddressString NOTIFY finalAddressStringChanged)
-    Q_PROPERTY(int port READ getPort WRITE setPort NOTIFY portChanged)
+    Q_PROPERTY(QString targets READ getTargets WRITE setTargets NOTIFY targetsChanged)
+    Q_PROPERTY(QString targetsFile READ getTargetsFile WRITE setTargetsFile NOTIFY targetsFileChanged)
+    Q_PROPERTY(QString ports READ getPorts WRITE setPorts NOTIFY portsChanged)
     Q_PROPERTY(int maxThreads READ getNumberOfThreads WRITE setNumberOfThreads NOTIFY maxThreadsChanged)
+    Q_PROPERTY(int minThreads READ getMinThreads WRITE setMinThreads NOTIFY minThreadsChanged)
+    Q_PROPERTY(bool adaptiveConcurrency READ getAdaptiveConcurrency WRITE setAdaptiveConcurrency NOTIFY adaptiveConcurrencyChanged)
+    Q_PROPERTY(int concurrency READ getConcurrency NOTIFY concurrencyChanged)
+    Q_PROPERTY(int rateLimit READ getRateLimit WRITE setRateLimit NOTIFY rateLimitChanged)
+    Q_PROPERTY(int rateBurst READ getRateBurst WRITE setRateBurst NOTIFY rateBurstChanged)
+    Q_PROPERTY(int workerThreads READ getWorkerThreads WRITE setWorkerThreads NOTIFY workerThreadsChanged)
     Q_PROPERTY(int timeout READ getTimeout WRITE setTimeout NOTIFY timeoutChanged)
+    Q_PROPERTY(int minTimeout READ getMinTimeout WRITE setMinTimeout NOTIFY minTimeoutChanged)
+    Q_PROPERTY(bool adaptiveTimeout READ getAdaptiveTimeout WRITE setAdaptiveTimeout NOTIFY adaptiveTimeoutChanged)
+    Q_PROPERTY(bool connectSweep READ getConnectSweep WRITE setConnectSweep NOTIFY connectSweepChanged)
+    Q_PROPERTY(bool resumeScans READ getResumeScans WRITE setResumeScans NOTIFY resumeScansChanged)
+    Q_PROPERTY(QString checkpointFile READ getCheckpointFile WRITE setCheckpointFile NOTIFY checkpointFileChanged)
+    Q_PROPERTY(bool useHostCache READ getUseHostCache WRITE setUseHostCache NOTIFY useHostCacheChanged)
+    Q_PROPERTY(QString hostCacheFile READ getHostCacheFile WRITE setHostCacheFile NOTIFY hostCacheFileChanged)
+    Q_PROPERTY(int liveTtl READ getLiveTtl WRITE setLiveTtl NOTIFY liveTtlChanged)
+    Q_PROPERTY(int refusedTtl READ getRefusedTtl WRITE setRefusedTtl NOTIFY refusedTtlChanged)
+    Q_PROPERTY(int deadTtl READ getDeadTtl WRITE setDeadTtl NOTIFY deadTtlChanged)
+    Q_PROPERTY(bool benchmark READ getBenchmark WRITE setBenchmark NOTIFY benchmarkChanged)
+    Q_PROPERTY(int benchmarkSamples READ getBenchmarkSamples WRITE setBenchmarkSamples NOTIFY benchmarkSamplesChanged)
+    Q_PROPERTY(QString judgeUrl READ getJudgeUrl WRITE setJudgeUrl NOTIFY judgeUrlChanged)
+    Q_PROPERTY(int connectTimeout READ getConnectTimeout WRITE setConnectTimeout NOTIFY connectTimeoutChanged)
     Q_PROPERTY(RequestType requestType READ getRequestType WRITE setRequestType NOTIFY requestTypeChanged)
+    Q_PROPERTY(Engine engine READ getEngine WRITE setEngine NOTIFY engineChanged)
     Q_PROPERTY(QString requestUrl READ getRequestUrl WRITE setRequestUrl NOTIFY requestUrlChanged)
-    Q_PROPERTY(QList<QObject *> reportModel READ getReport NOTIFY reportChanged)
+    Q_PROPERTY(QString outputFile READ getOutputFile WRITE setOutputFile NOTIFY outputFileChanged)
+    Q_PROPERTY(OutputFormat outputFormat READ getOutputFormat WRITE setOutputFormat NOTIFY outputFormatChanged)
+    Q_PROPERTY(ReportModel *reportModel READ getReportModel CONSTANT)
     Q_PROPERTY(QVariantList filteredCodes READ getFilteredCodes NOTIFY filteredCodesChanged)
+    Q_PROPERTY(QVariantMap statistics READ getStatistics NOTIFY statisticsChanged)
     Q_PROPERTY(int status READ getStatus NOTIFY statusChanged)
     Q_PROPERTY(bool running READ getRunning NOTIFY runningChanged)
     Q_PROPERTY(bool gettingAddresses READ getGettingAddresses NOTIFY gettingAddressesChanged)
-    Q_PROPERTY(bool settingCheckers READ getSettingCheckers NOTIFY settingCheckersChanged)
     Q_PROPERTY(bool scaning READ getScaning NOTIFY scaningChanged)
     Q_PROPERTY(bool validInitialAddress READ getValidInitialAddress NOTIFY validInitialAddressChanged)
     Q_PROPERTY(bool validFinalAddress READ getValidFinalAddress NOTIFY validFinalAddressChanged)
-    Q_PROPERTY(unsigned progressTotal READ getProgressTotal NOTIFY progressTotalChanged)
-    Q_PROPERTY(unsigned progressPartial READ getProgressPartial NOTIFY progressPartialChanged)
+    Q_PROPERTY(bool validTargets READ getValidTargets NOTIFY validTargetsChanged)
+    Q_PROPERTY(bool validPorts READ getValidPorts NOTIFY validPortsChanged)
+    Q_PROPERTY(double progressTotal READ getProgressTotal NOTIFY progressTotalChanged)
+    Q_PROPERTY(double progressPartial READ getProgressPartial NOTIFY progressPartialChanged)
     Q_PROPERTY(double progress READ getProgress NOTIFY progressChanged)
 
 public:
 
-    enum RequestType { HTTP, HTTPS, FTP };
+    enum RequestType { HTTP, HTTPS, FTP, Detect };
     Q_ENUM(RequestType)
-    enum Status { ReadyFirsTime, GettingAddresses, SettingCheckers, Scaning, FinishedAndReady, AbortedAndReady };
+    enum Engine { QtNetwork, Native };
+    Q_ENUM(Engine)
+    enum OutputFormat { NDJSON = ResultSink::NDJSON, CSV = ResultSink::CSV };
+    Q_ENUM(OutputFormat)
+    enum Status { ReadyFirsTime, GettingAddresses, Scaning, FinishedAndReady, AbortedAndReady };
     Q_ENUM(Status)
 
     ThreadedFinder(QObject *parent = nullptr);
     ~ThreadedFinder() override;
 
+    // Engine configured as the scans use it, owned by the caller. The
+    // benchmarks replace it with one answering at once.
+    virtual ProbeEngine *createProbeEngine() const;
+
     void run() override;
 
     unsigned int getNumberOfThreads() const;
     void setNumberOfThreads(unsigned int value);
 
+    unsigned int getMinThreads() const;
+    void setMinThreads(unsigned int value);
+
+    bool getAdaptiveConcurrency() const;
+    void setAdaptiveConcurrency(bool value);
+
+    int getConcurrency() const;
+    void setConcurrency(int value);
+
+    int getRateLimit() const;
+    void setRateLimit(int value);
+
+    int getRateBurst() const;
+    void setRateBurst(int value);
+
+    int getWorkerThreads() const;
+    void setWorkerThreads(int value);
+
     QHostAddress getInitialAddress() const;
     void setInitialAddress(const QHostAddress &value);
 
     QHostAddress getFinalAddress() const;
     void setFinalAddress(const QHostAddress &value);
 
-    unsigned short getPort() const;
-    void setPort(unsigned short value);
+    QString getTargets() const;
+    void setTargets(const QString &value);
+
+    QString getTargetsFile() const;
+    void setTargetsFile(const QString &value);
 
-    QList<QObject *> getReport() const;
+    QString getPorts() const;
+    void setPorts(const QString &value);
+
+    ReportModel *getReportModel() const;
+
+    // Latencies of the stages of the checks and their outcomes, so far.
+    // Thread safe, and kept after the scan until the next one starts.
+    ScanStatistics::Snapshot statisticsSnapshot() const;
+    QVariantMap getStatistics() const;
+    const ResultStore *getResults() const;
 
     QString getInitialAddressString() const;
     void setInitialAddressString(const QString &value);
@@ -74,108 +152,255 @@ public:
     bool getValidFinalAddress() const;
     void setValidFinalAddress(bool value);
 
+    bool getValidTargets() const;
+    void setValidTargets(bool value);
+
+    bool getValidPorts() const;
+    void setValidPorts(bool value);
+
     int getTimeout() const;
     void setTimeout(int value);
 
+    int getMinTimeout() const;
+    void setMinTimeout(int value);
+
+    bool getAdaptiveTimeout() const;
+    void setAdaptiveTimeout(bool value);
+
+    bool getConnectSweep() const;
+    void setConnectSweep(bool value);
+
+    bool getResumeScans() const;
+    void setResumeScans(bool value);
+
+    QString getCheckpointFile() const;
+    void setCheckpointFile(const QString &value);
+
+    bool getUseHostCache() const;
+    void setUseHostCache(bool value);
+
+    QString getHostCacheFile() const;
+    void setHostCacheFile(const QString &value);
+
+    int getLiveTtl() const;
+    void setLiveTtl(int value);
+
+    int getRefusedTtl() const;
+    void setRefusedTtl(int value);
+
+    int getDeadTtl() const;
+    void setDeadTtl(int value);
+
+    bool getBenchmark() const;
+    void setBenchmark(bool value);
+
+    int getBenchmarkSamples() const;
+    void setBenchmarkSamples(int value);
+
+    QString getJudgeUrl() const;
+    void setJudgeUrl(const QString &value);
+
+    int getConnectTimeout() const;
+    void setConnectTimeout(int value);
+
     RequestType getRequestType() const;
     void setRequestType(const RequestType &value);
 
+    Engine getEngine() const;
+    void setEngine(const Engine &value);
+
     QString getRequestUrl() const;
     void setRequestUrl(const QString &value);
 
+    QString getOutputFile() const;
+    void setOutputFile(const QString &value);
+
+    OutputFormat getOutputFormat() const;
+    void setOutputFormat(const OutputFormat &value);
+
     double getProgress() const;
     void setProgress(double value);
 
-    bool getSettingCheckers() const;
-    void setSettingCheckers(bool value);
-
     bool getRunning() const;
     void setRunning(bool value);
 
     bool getGettingAddresses() const;
     void setGettingAddresses(bool value);
 
-    unsigned getProgressTotal() const;
-    void setProgressTotal(unsigned value);
+    double getProgressTotal() const;
+    void setProgressTotal(double value);
 
-    unsigned getProgressPartial() const;
-    void setProgressPartial(unsigned value);
+    double getProgressPartial() const;
+    void setProgressPartial(double value);
 
     int getStatus() const;
     void setStatus(const Status &value);
 
 signals:
-    void replied(QNetworkReply *reply);
     void singleCheckFinished();
+    // Emitted from the finder thread for every reply, filtered or not
+    void checkReplied(const IpAddress &address, unsigned short port, int error, const QString &reason);
     void scanFinished();
 
     // properties
-    void portChanged(unsigned short newPort);
+    void targetsChanged(const QString &newTargets);
+    void targetsFileChanged(const QString &newTargetsFile);
+    void portsChanged(const QString &newPorts);
     void maxThreadsChanged(unsigned int newMaxThreads);
+    void minThreadsChanged(unsigned int newMinThreads);
+    void adaptiveConcurrencyChanged(bool enabled);
+    void concurrencyChanged(int newConcurrency);
+    void rateLimitChanged(int newRateLimit);
+    void rateBurstChanged(int newRateBurst);
+    void workerThreadsChanged(int newWorkerThreads);
     void timeoutChanged(int t);
+    void minTimeoutChanged(int t);
+    void adaptiveTimeoutChanged(bool enabled);
+    void connectSweepChanged(bool enabled);
+    void connectTimeoutChanged(int t);
+    void resumeScansChanged(bool enabled);
+    void checkpointFileChanged(const QString &newCheckpointFile);
+    void useHostCacheChanged(bool enabled);
+    void hostCacheFileChanged(const QString &newHostCacheFile);
+    void liveTtlChanged(int minutes);
+    void refusedTtlChanged(int minutes);
+    void deadTtlChanged(int minutes);
+    void benchmarkChanged(bool enabled);
+    void benchmarkSamplesChanged(int samples);
+    void judgeUrlChanged(const QString &newJudgeUrl);
     void requestTypeChanged(RequestType newType);
     void requestUrlChanged(const QString &newUrl);
-    void reportChanged(QList<QObject*> updatedReport);
+    void engineChanged(Engine newEngine);
+    void outputFileChanged(const QString &newOutputFile);
+    void outputFormatChanged(OutputFormat newOutputFormat);
     void filteredCodesChanged(const QVariantList &updatedFilters);
+    // Every second while scanning, and once done
+    void statisticsChanged();
     void initialAddressStringChanged(const QString &newAddressString);
     void finalAddressStringChanged(const QString &newAddressString);
     void statusChanged(int updatedStatus);
     void runningChanged(bool isRunning);
     void gettingAddressesChanged(bool isGettingAddresses);
-    void settingCheckersChanged(bool isSettingCheckers);
     void scaningChanged(bool isScaning);
     void validInitialAddressChanged(bool isValid);
     void validFinalAddressChanged(bool isValid);
-    void progressTotalChanged(unsigned total);
-    void progressPartialChanged(unsigned partial);
+    void validTargetsChanged(bool isValid);
+    void validPortsChanged(bool isValid);
+    void progressTotalChanged(double total);
+    void progressPartialChanged(double partial);
     void progressChanged(double updatedProgress);
 
 public slots:
     void updateReport();
     void clean();
+    void stop();
     void updateProgress();
     bool addressesAreInverted();
 
 private slots:
     void fillQueue();
-    void setupNetworkCheckers();
     void launchNetworkCheckers();
-    void onReplied(QNetworkReply *reply, ProxyCheckerThreadWrapper *obj);
+    void onReplied(quint64 sequence, const IpAddress &address, unsigned short port, int error, const QString &reason, int protocols);
 
 private:
-    void addInfoToReportUsingFilters(ProxyInfo *info);
+    void updateValidTargets();
+    QSet<int> filterSet() const;
+    void releaseCompletedChecks();
+    bool pendingCheck(quint64 sequence, qint64 *startedAt) const;
+    void completeCheck(quint64 sequence, const ScanResult &result);
+    QNetworkProxy::ProxyType benchmarkProxyType(int protocols) const;
+    void continueScan();
+    bool scanCompleted() const;
+    int checkTimeout(const IpAddress &address) const;
+    void loadHostCache();
+    void saveHostCache();
+    QByteArray scanFingerprint() const;
+    void resumeFromCheckpoint();
+    ScanCheckpoint checkpoint() const;
+    void saveCheckpoint();
 
 private:
     unsigned int maxThreads = 300;
+    unsigned int minThreads = 50;
+    bool adaptiveConcurrency = true;
+    int concurrency = 0; // checks allowed in flight right now
+    int rateLimit = 0; // checks started per second, 0 without limit
+    int rateBurst = 100;
+    int workerThreads = QThread::idealThreadCount();
     int timeout = 1000;
+    int minTimeout = 250;
+    bool adaptiveTimeout = true;
+    bool connectSweep = true;
+    int connectTimeout = 300;
+    bool resumeScans = true;
+    QString checkpointFile;
+    bool useHostCache = true;
+    QString hostCacheFile;
+    // Minutes
+    int liveTtl = 24 * 60;
+    int refusedTtl = 6 * 60;
+    int deadTtl = 60;
+    bool benchmark = false;
+    int benchmarkSamples = 3;
+    QString judgeUrl = "http://azenv.net/";
     RequestType requestType = HTTP;
     QString requestUrl = "google.com";
+    Engine engine = QtNetwork;
+    QString outputFile;
+    OutputFormat outputFormat = NDJSON;
     QHostAddress initialAddress, finalAddress;
     QString initialAddressString, finalAddressString;
-    unsigned short port = 0;
+    QString targets, targetsFile;
+    QString ports;
+    PortSet portSet;
 
     Status status = ReadyFirsTime;
     bool running = false;
     bool gettingAddresses = false;
-    bool settingCheckers = false;
     bool scaning = false;
 
-    unsigned int launchIndex;
+    TargetGenerator targetGenerator;
     bool validInitialAddress = false;
     bool validFinalAddress = false;
-    unsigned int progressTotal = 1;
-    unsigned int progressPartial = 0;
+    bool validTargets = true;
+    bool validPorts = false;
+    // IPv6 sets may not fit in 32 bits, so the progress is counted in doubles
+    double progressTotal = 1;
+    double progressPartial = 0;
     double progress = 0.0;
     int totalAddressesToScan = 1;
-    QNetworkProxy::ProxyType requestTypeToProxyType[3] = { QNetworkProxy::HttpCachingProxy, QNetworkProxy::HttpCachingProxy, QNetworkProxy::FtpCachingProxy };
-    QStringList requestTypeToProtocolString = QStringList() << "http" << "https" << "ftp";
+    QNetworkProxy::ProxyType requestTypeToProxyType[4] = { QNetworkProxy::HttpCachingProxy, QNetworkProxy::HttpCachingProxy, QNetworkProxy::FtpCachingProxy,
+                                                           QNetworkProxy::HttpCachingProxy };
+    QStringList requestTypeToProtocolString = QStringList() << "http" << "https" << "ftp" << "http";
 
     unsigned int runningCheckers = 0;
-    unsigned int addressesToScan = 0;
-    QList<ProxyCheckerThreadWrapper*> connectedCheckers;
-    QList<QObject*> checkersToDelete;
-    QList<QObject*> report;
-    QList<QObject*> fullReport;
+    quint64 addressesToScan = 0;
+    ProbeEngine *probeEngine = nullptr;
+    ResultWriter *resultWriter = nullptr;
+    ProxyBenchmark *proxyBenchmark = nullptr; // while benchmarking the hits
+    quint64 nextSequence = 0;
+    quint64 firstPendingSequence = 0;
+    quint64 scanBaseSequence = 0; // sequence of the first target of the scan
+    QSet<quint64> resumedTargets; // checked before the checkpoint, beyond its watermark
+    QByteArray fingerprint;
+    QQueue<qint64> pendingChecks; // dispatch time of each check in flight, or -1 once replied, from firstPendingSequence on
+    QElapsedTimer clock;
+    ResultStore results;
+    ReportModel *reportModel = nullptr;
+    ConcurrencyController concurrencyController;
+    RateLimiter rateLimiter;
+    RttEstimator rttEstimator;
+    QTimer *dispatchTimer = nullptr;
+    HostCache hostCache;
+    QQueue<ScanTarget> priorityTargets; // live proxies of previous scans, checked first
+    QSet<QPair<IpAddress, unsigned short>> prioritizedTargets;
+    QHash<quint64, qint64> priorityChecks; // dispatch time by sequence
+    QVector<ScanTarget> completedPriorityTargets; // checkpointed, so a resumed scan doesn't check them again
+    quint64 nextPrioritySequence = 0; // without the PrioritySequence bit
+    quint64 skippedTargets = 0;
+    ScanStatistics scanStatistics;
+    ScanStatistics::Shard *statisticsShard = nullptr; // of the finder thread, while scanning
+    QTimer timerStatistics;
     QVariantList filteredCodes = QVariantList() << QNetworkReply::NoError
                                                 << QNetworkReply::ProxyAuthenticationRequiredError;
 };
@@ -0,0 +1,159 @@
+#include "timerwheel.h"
+
+// Short of a whole round of the outermost level, so its slots are never ambiguous
+static const qint64 MaximumDelay = qint64(255) << 24;
+
+TimerWheel::TimerWheel(qint64 now)
+{
+    current = now;
+    for (int &head : heads) {
+        head = -1;
+    }
+}
+
+quint64 TimerWheel::start(qint64 deadline, quint64 data)
+{
+    int node;
+    if (freeNodes.isEmpty()) {
+        node = nodes.count();
+        nodes.append(Node());
+    } else {
+        node = freeNodes.takeLast();
+    }
+
+    // Expired deadlines fire on the next tick, the slot of this one is done
+    Node &n = nodes[node];
+    n.expiry = qBound(current + 1, deadline, current + MaximumDelay);
+    n.data = data;
+    n.generation++;
+    insert(node);
+    pending++;
+    return (quint64(n.generation) << 32) | quint32(node);
+}
+
+void TimerWheel::cancel(quint64 timer)
+{
+    const int node = int(timer & 0xFFFFFFFF);
+    if (node >= nodes.count() || nodes[node].slot < 0 || nodes[node].generation != quint32(timer >> 32)) {
+        return;
+    }
+    unlink(node);
+    release(node);
+}
+
+void TimerWheel::clear()
+{
+    for (int node = 0; node < nodes.count(); ++node) {
+        if (nodes[node].slot >= 0) {
+            unlink(node);
+            release(node);
+        }
+    }
+}
+
+bool TimerWheel::isEmpty() const
+{
+    return pending == 0;
+}
+
+int TimerWheel::count() const
+{
+    return pending;
+}
+
+qint64 TimerWheel::nextExpiry() const
+{
+    if (pending == 0) {
+        return -1;
+    }
+    // Exact for the innermost level, the outer ones are only known to wait for the next cascade
+    const qint64 cascade = ((current >> SlotBits) + 1) << SlotBits;
+    if (levelCounts[0] > 0) {
+        for (qint64 tick = current + 1; tick <= current + Slots; ++tick) {
+            if (heads[tick & SlotMask] >= 0) {
+                return pending > levelCounts[0] ? qMin(tick, cascade) : tick;
+            }
+        }
+    }
+    return cascade;
+}
+
+void TimerWheel::advance(qint64 now, QVector<quint64> &expired)
+{
+    while (current < now) {
+        if (pending == 0) {
+            current = now;
+            break;
+        }
+        current++;
+
+        // Outer levels first, so their timers can cascade all the way in
+        int level = 0;
+        while (level + 1 < Levels && (current & ((qint64(1) << (SlotBits * (level + 1))) - 1)) == 0) {
+            level++;
+        }
+        for (; level > 0; --level) {
+            cascade(level);
+        }
+
+        int &head = heads[current & SlotMask];
+        while (head >= 0) {
+            const int node = head;
+            unlink(node);
+            expired.append(nodes[node].data);
+            release(node);
+        }
+    }
+}
+
+void TimerWheel::insert(int node)
+{
+    Node &n = nodes[node];
+    // The innermost level whose current round reaches the expiry
+    int level = 0;
+    while (level + 1 < Levels && (n.expiry >> (SlotBits * level)) - (current >> (SlotBits * level)) >= Slots) {
+        level++;
+    }
+    n.slot = level * Slots + int((n.expiry >> (SlotBits * level)) & SlotMask);
+    n.previous = -1;
+    n.next = heads[n.slot];
+    if (n.next >= 0) {
+        nodes[n.next].previous = node;
+    }
+    heads[n.slot] = node;
+    levelCounts[level]++;
+}
+
+void TimerWheel::unlink(int node)
+{
+    Node &n = nodes[node];
+    if (n.previous >= 0) {
+        nodes[n.previous].next = n.next;
+    } else {
+        heads[n.slot] = n.next;
+    }
+    if (n.next >= 0) {
+        nodes[n.next].previous = n.previous;
+    }
+    levelCounts[n.slot / Slots]--;
+}
+
+void TimerWheel::release(int node)
+{
+    nodes[node].slot = -1;
+    freeNodes.append(node);
+    pending--;
+}
+
+void TimerWheel::cascade(int level)
+{
+    const int slot = level * Slots + int((current >> (SlotBits * level)) & SlotMask);
+    int node = heads[slot];
+    heads[slot] = -1;
+    while (node >= 0) {
+        const int next = nodes[node].next;
+        levelCounts[level]--;
+        insert(node);
+        node = next;
+    }
+}
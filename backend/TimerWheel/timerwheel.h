@@ -0,0 +1,55 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QVector>
+
+// Hierarchical timing wheel: four levels of 256 slots with millisecond ticks,
+// spanning about 48 days. Timers are nodes of intrusive lists, so starting and
+// cancelling one is O(1) and allocation free once the pool has grown. Timers
+// of the outer levels cascade inwards as the inner levels wrap around, and
+// only the innermost level fires, so advancing costs O(1) per tick plus the
+// expired timers, whatever the number of timers pending.
+class TimerWheel
+{
+public:
+    // Times are in milliseconds, of any monotonic clock
+    explicit TimerWheel(qint64 now = 0);
+
+    // Returns a handle, still valid to cancel() after the timer fires or is cancelled
+    quint64 start(qint64 deadline, quint64 data);
+    void cancel(quint64 timer);
+    void clear();
+
+    bool isEmpty() const;
+    int count() const;
+    // When advance() has to be called next, -1 without timers
+    qint64 nextExpiry() const;
+    // Appends the data of the expired timers
+    void advance(qint64 now, QVector<quint64> &expired);
+
+private:
+    enum { Levels = 4, SlotBits = 8, Slots = 1 << SlotBits, SlotMask = Slots - 1 };
+
+    struct Node {
+        qint64 expiry = 0;
+        quint64 data = 0;
+        quint32 generation = 0;
+        int slot = -1; // -1 while unused
+        int previous = -1;
+        int next = -1;
+    };
+
+    void insert(int node);
+    void unlink(int node);
+    void release(int node);
+    void cascade(int level);
+
+    qint64 current = 0;
+    int pending = 0;
+    int levelCounts[Levels] = {};
+    int heads[Levels * Slots];
+    QVector<Node> nodes;
+    QVector<int> freeNodes;
+};
+
+#endif // TIMERWHEEL_H
@@ -1,27 +1,72 @@
 #include "reportmodel.h"
-#include <QDebug>
+#include "../../ProxyBenchmark/proxybenchmark.h"
+#include <algorithm>
 
-ReportModel::ReportModel(QList<ProxyInfo *> dataReport, QObject *parent) : QAbstractListModel(parent)
+// Past this many new rows, sorting them all again is cheaper than inserting them one by one
+static const int MaximumSortedInsertions = 64;
+
+ReportModel::ReportModel(const ResultStore *resultStore, int updateInterval, QObject *parent) : QAbstractListModel(parent)
 {
-    report = dataReport;
+    store = resultStore;
+    timerUpdate.setSingleShot(true);
+    timerUpdate.setInterval(updateInterval);
+    connect(&timerUpdate, &QTimer::timeout, this, &ReportModel::update);
 }
 
 int ReportModel::rowCount(const QModelIndex &parent) const
 {
-    (void)parent;
-    //qDebug() << report.count();
-    return report.count();
+    if (parent.isValid()) {
+        return 0;
+    }
+    return rows;
 }
 
 QVariant ReportModel::data(const QModelIndex &index, int role) const
 {
+    if (!index.isValid() || index.row() >= rows) {
+        return QVariant();
+    }
+
+    int bucket = 0;
+    int position = index.row();
+    if (sortRole != 0) {
+        bucket = order[position].bucket;
+        position = order[position].position;
+    } else {
+        // There are a few buckets at most, so they are walked
+        while (bucket < published.count() && position >= published[bucket]) {
+            position -= published[bucket];
+            bucket++;
+        }
+    }
+    ScanResult result;
+    if (!store->filteredAt(generation, bucket, position, &result)) {
+        return QVariant();
+    }
+
     switch (role) {
     case HostNameRole:
-        return report[index.row()]->getHostName();
+        return result.address.toString();
+    case PortRole:
+        return result.port;
     case HttpStatusCodeRole:
-        return report[index.row()]->getHttpStatusCode();
+        return result.error;
     case HttpReasonPhraseRole:
-        return report[index.row()]->getHttpReasonPhrase();
+        return result.reason;
+    case LatencyRole:
+        return result.latency;
+    case ProtocolsRole:
+        return result.protocols;
+    case BenchmarkSamplesRole:
+        return result.benchmark.samples;
+    case ConnectTimeRole:
+        return result.benchmark.connectTime;
+    case FirstByteTimeRole:
+        return result.benchmark.firstByteTime;
+    case ThroughputRole:
+        return result.benchmark.throughput;
+    case AnonymityRole:
+        return ProxyBenchmark::anonymityName(result.benchmark.anonymity);
     default:
         return QVariant();
     }
@@ -31,50 +76,196 @@ QHash<int, QByteArray> ReportModel::roleNames() const
 {
     QHash<int, QByteArray> roles;
     roles[HostNameRole] = "hostName";
+    roles[PortRole] = "port";
     roles[HttpStatusCodeRole] = "httpStatusCode";
     roles[HttpReasonPhraseRole] = "httpReasonPhrase";
+    roles[LatencyRole] = "latency";
+    roles[ProtocolsRole] = "protocols";
+    roles[BenchmarkSamplesRole] = "benchmarkSamples";
+    roles[ConnectTimeRole] = "connectTime";
+    roles[FirstByteTimeRole] = "firstByteTime";
+    roles[ThroughputRole] = "throughput";
+    roles[AnonymityRole] = "anonymity";
     return roles;
 }
 
-bool ReportModel::insertRows(int row, int count, const QModelIndex &parent)
+void ReportModel::scheduleUpdate()
+{
+    // Only the first request since the last update posts an event
+    if (updateScheduled.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, [=] {
+            if (!timerUpdate.isActive()) {
+                timerUpdate.start();
+            }
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ReportModel::update()
+{
+    updateScheduled.storeRelease(0);
+
+    quint32 currentGeneration;
+    const QVector<int> sizes = store->filteredBucketSizes(&currentGeneration);
+    if (currentGeneration != generation) {
+        // The rows were cleared or filtered again, so the old ones are gone
+        if (rows > 0) {
+            beginRemoveRows(QModelIndex(), 0, rows - 1);
+            rows = 0;
+            published.fill(0);
+            order.clear();
+            endRemoveRows();
+        }
+        generation = currentGeneration;
+        published = QVector<int>(sizes.count(), 0);
+    }
+
+    if (sortRole != 0) {
+        int added = 0;
+        for (int i = 0; i < sizes.count(); ++i) {
+            added += sizes[i] - published[i];
+        }
+        if (added > MaximumSortedInsertions) {
+            refresh();
+            return;
+        }
+        // The new rows go to their place in the order
+        for (int i = 0; i < sizes.count(); ++i) {
+            for (; published[i] < sizes[i]; ++published[i]) {
+                const SortedRow row = sortedRow(i, published[i]);
+                const auto place = std::upper_bound(order.begin(), order.end(), row, [this](const SortedRow &a, const SortedRow &b) {
+                    return lessThan(a, b);
+                });
+                const int index = int(place - order.begin());
+                beginInsertRows(QModelIndex(), index, index);
+                order.insert(index, row);
+                rows++;
+                endInsertRows();
+            }
+        }
+        return;
+    }
+
+    // Every bucket grows at its end, which is in the middle of the view for all but the last one
+    int offset = 0;
+    for (int i = 0; i < sizes.count(); ++i) {
+        if (sizes[i] > published[i]) {
+            beginInsertRows(QModelIndex(), offset + published[i], offset + sizes[i] - 1);
+            rows += sizes[i] - published[i];
+            published[i] = sizes[i];
+            endInsertRows();
+        }
+        offset += published[i];
+    }
+}
+
+void ReportModel::refresh()
 {
-    qDebug() << "Insert rows";
-    if (row <= 0 || row > report.count()) {
-        return false;
+    timerUpdate.stop();
+    updateScheduled.storeRelease(0);
+    beginResetModel();
+    published = store->filteredBucketSizes(&generation);
+    rows = 0;
+    for (int size : published) {
+        rows += size;
     }
-    beginInsertRows(parent, row, row + count);
-    endInsertRows();
-    return true;
+    sortRows();
+    endResetModel();
+}
+
+int ReportModel::getSortRole() const
+{
+    return sortRole;
 }
 
-bool ReportModel::removeRows(int row, int count, const QModelIndex &parent)
+void ReportModel::setSortRole(int role)
 {
-    qDebug() << "Remove rows";
-    if (row < 0 || row >= report.count()) {
-        return false;
+    if (sortRole != role) {
+        sortRole = role;
+        refresh();
+        emit sortRoleChanged(role);
     }
-    beginRemoveRows(parent, row, row + count);
-    for (int i = row; i <= row + count; ++i) {
-        report.removeAt(i);
+}
+
+int ReportModel::getSortOrder() const
+{
+    return sortOrder;
+}
+
+void ReportModel::setSortOrder(int order)
+{
+    const Qt::SortOrder value = order == Qt::DescendingOrder ? Qt::DescendingOrder : Qt::AscendingOrder;
+    if (sortOrder != value) {
+        sortOrder = value;
+        refresh();
+        emit sortOrderChanged(value);
     }
-    qDebug() << report.count();
-    endRemoveRows();
-    return true;
 }
 
-QList<ProxyInfo *> ReportModel::getReport() const
+bool ReportModel::lessThan(const SortedRow &a, const SortedRow &b) const
 {
-    return report;
+    if (a.measured != b.measured) {
+        return a.measured;
+    }
+    return sortOrder == Qt::AscendingOrder ? a.key < b.key : a.key > b.key;
 }
 
-void ReportModel::append(ProxyInfo *info)
+ReportModel::SortedRow ReportModel::sortedRow(int bucket, int position) const
 {
-    report.append(info);
-    insertRow(rowCount());
+    SortedRow row = { bucket, position, false, 0 };
+    ScanResult result;
+    if (!store->filteredAt(generation, bucket, position, &result)) {
+        return row;
+    }
+    const BenchmarkResult &benchmark = result.benchmark;
+    switch (sortRole) {
+    case LatencyRole:
+        row.measured = true;
+        row.key = result.latency;
+        break;
+    case ConnectTimeRole:
+        row.measured = benchmark.connectTime > 0;
+        row.key = benchmark.connectTime;
+        break;
+    case FirstByteTimeRole:
+        row.measured = benchmark.samples > 0;
+        row.key = benchmark.firstByteTime;
+        break;
+    case ThroughputRole:
+        row.measured = benchmark.throughput > 0;
+        row.key = benchmark.throughput;
+        break;
+    case AnonymityRole:
+        row.measured = benchmark.anonymity != ProxyBenchmark::UnknownAnonymity;
+        row.key = benchmark.anonymity;
+        break;
+    case HttpStatusCodeRole:
+        row.measured = true;
+        row.key = result.error;
+        break;
+    case PortRole:
+        row.measured = true;
+        row.key = result.port;
+        break;
+    default:
+        break;
+    }
+    return row;
 }
 
-void ReportModel::clear()
+void ReportModel::sortRows()
 {
-    removeRows(0, report.count());
-    //report.clear();
+    order.clear();
+    if (sortRole == 0) {
+        return;
+    }
+    order.reserve(rows);
+    for (int bucket = 0; bucket < published.count(); ++bucket) {
+        for (int position = 0; position < published[bucket]; ++position) {
+            order.append(sortedRow(bucket, position));
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](const SortedRow &a, const SortedRow &b) {
+        return lessThan(a, b);
+    });
 }
@@ -2,36 +2,74 @@
 #define REPORTMODEL_H
 
 #include <QAbstractListModel>
-#include "../../ProxyInfo/proxyinfo.h"
+#include <QAtomicInt>
+#include <QTimer>
+#include "../../ResultStore/resultstore.h"
 
+// Thin list model over the filtered view of a ResultStore. It holds no copy
+// of the results, only how many rows of every filtered bucket it published,
+// and rows are read from the store when the view asks for them. New rows are
+// announced in batches, at most once per update interval, so the cost of the
+// view depends on the rows added and not on the total. Sorted by a measure,
+// the model keeps the order of the rows published, new ones inserted in place,
+// and rows without that measure go last.
 class ReportModel : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(int sortRole READ getSortRole WRITE setSortRole NOTIFY sortRoleChanged)
+    Q_PROPERTY(int sortOrder READ getSortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
 public:
-    explicit ReportModel(QList<ProxyInfo*> dataReport = QList<ProxyInfo*>(), QObject *parent = nullptr);
+    explicit ReportModel(const ResultStore *resultStore, int updateInterval = 100, QObject *parent = nullptr);
 
-    enum Roles { HostNameRole = Qt::UserRole + 1, HttpStatusCodeRole, HttpReasonPhraseRole };
+    enum Roles { HostNameRole = Qt::UserRole + 1, HttpStatusCodeRole, HttpReasonPhraseRole, PortRole, LatencyRole, ProtocolsRole,
+                 BenchmarkSamplesRole, ConnectTimeRole, FirstByteTimeRole, ThroughputRole, AnonymityRole };
     Q_ENUM(Roles)
 
     // Pure virtual functions
-    int rowCount(const QModelIndex &parent = QModelIndex()) const;
-    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
-    QHash<int, QByteArray> roleNames() const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
 
-    // Others virtual functions
-    bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex());
-    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex());
+    // Thread safe
+    void scheduleUpdate();
 
-    QList<ProxyInfo *> getReport() const;
-    void append(ProxyInfo *info);
+    // 0 for the arrival order
+    int getSortRole() const;
+    void setSortRole(int role);
+
+    // Qt::AscendingOrder or Qt::DescendingOrder
+    int getSortOrder() const;
+    void setSortOrder(int order);
 
 signals:
+    void sortRoleChanged(int role);
+    void sortOrderChanged(int order);
 
 public slots:
-    void clear();
+    void update();
+    void refresh();
 
 private:
-    QList<ProxyInfo*> report;
+    struct SortedRow {
+        int bucket;
+        int position;
+        bool measured;
+        qint64 key;
+    };
+
+    bool lessThan(const SortedRow &a, const SortedRow &b) const;
+    SortedRow sortedRow(int bucket, int position) const;
+    void sortRows();
+
+    const ResultStore *store;
+    QVector<int> published; // rows published of every bucket
+    int rows = 0;
+    quint32 generation = 0;
+    int sortRole = 0;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+    QVector<SortedRow> order; // rows published, while sorted
+    QTimer timerUpdate;
+    QAtomicInt updateScheduled;
 };
 
 #endif // REPORTMODEL_H
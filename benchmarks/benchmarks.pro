@@ -0,0 +1,68 @@
+QT -= gui
+QT += network
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = proxyfinder-benchmarks
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# The scanner sources, as ProxyFinder.pro builds them, without the UI
+BACKEND = ../backend
+
+HEADERS += \
+    nullprobeengine.h \
+    $$BACKEND/IpAddress/ipaddress.h \
+    $$BACKEND/AddressSet/addressset.h \
+    $$BACKEND/PortSet/portset.h \
+    $$BACKEND/TargetGenerator/targetgenerator.h \
+    $$BACKEND/ProxyChecker/proxychecker.h \
+    $$BACKEND/ProbeEngine/probeengine.h \
+    $$BACKEND/ProxyCheckerPool/proxycheckerpool.h \
+    $$BACKEND/ConcurrencyController/concurrencycontroller.h \
+    $$BACKEND/RateLimiter/ratelimiter.h \
+    $$BACKEND/RttEstimator/rttestimator.h \
+    $$BACKEND/TimerWheel/timerwheel.h \
+    $$BACKEND/LatencyHistogram/latencyhistogram.h \
+    $$BACKEND/ScanStatistics/scanstatistics.h \
+    $$BACKEND/HostCache/hostcache.h \
+    $$BACKEND/ProtocolDetector/protocoldetector.h \
+    $$BACKEND/ProxyBenchmark/proxybenchmark.h \
+    $$BACKEND/ThreadedFinder/threadedfinder.h \
+    $$BACKEND/ResultSink/resultsink.h \
+    $$BACKEND/ResultWriter/resultwriter.h \
+    $$BACKEND/ScanCheckpoint/scancheckpoint.h \
+    $$BACKEND/ScanResult/scanresult.h \
+    $$BACKEND/ResultStore/resultstore.h \
+    $$BACKEND/models/ReportModel/reportmodel.h
+
+SOURCES += \
+    main.cpp \
+    nullprobeengine.cpp \
+    $$BACKEND/IpAddress/ipaddress.cpp \
+    $$BACKEND/AddressSet/addressset.cpp \
+    $$BACKEND/PortSet/portset.cpp \
+    $$BACKEND/TargetGenerator/targetgenerator.cpp \
+    $$BACKEND/ProxyChecker/proxychecker.cpp \
+    $$BACKEND/ProbeEngine/probeengine.cpp \
+    $$BACKEND/ProxyCheckerPool/proxycheckerpool.cpp \
+    $$BACKEND/ConcurrencyController/concurrencycontroller.cpp \
+    $$BACKEND/RateLimiter/ratelimiter.cpp \
+    $$BACKEND/RttEstimator/rttestimator.cpp \
+    $$BACKEND/TimerWheel/timerwheel.cpp \
+    $$BACKEND/LatencyHistogram/latencyhistogram.cpp \
+    $$BACKEND/ScanStatistics/scanstatistics.cpp \
+    $$BACKEND/HostCache/hostcache.cpp \
+    $$BACKEND/ProtocolDetector/protocoldetector.cpp \
+    $$BACKEND/ProxyBenchmark/proxybenchmark.cpp \
+    $$BACKEND/ThreadedFinder/threadedfinder.cpp \
+    $$BACKEND/ResultSink/resultsink.cpp \
+    $$BACKEND/ResultWriter/resultwriter.cpp \
+    $$BACKEND/ScanCheckpoint/scancheckpoint.cpp \
+    $$BACKEND/ResultStore/resultstore.cpp \
+    $$BACKEND/models/ReportModel/reportmodel.cpp
+
+linux {
+    HEADERS += $$BACKEND/EpollProbeEngine/epollprobeengine.h
+    SOURCES += $$BACKEND/EpollProbeEngine/epollprobeengine.cpp
+}
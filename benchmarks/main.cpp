@@ -0,0 +1,344 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QTextStream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "nullprobeengine.h"
+#include "../backend/ThreadedFinder/threadedfinder.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// Every allocation of the process is counted, Qt's included
+static std::atomic<quint64> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Peak resident set size in KiB. Linux can restart it, so every case gets its
+// own peak; elsewhere it's the peak of the process so far.
+static void resetPeakRss()
+{
+#ifdef Q_OS_LINUX
+    QFile clearRefs("/proc/self/clear_refs");
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+static qint64 peakRss()
+{
+#ifdef Q_OS_LINUX
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef Q_OS_MACOS
+        return qint64(usage.ru_maxrss) / 1024;
+#else
+        return qint64(usage.ru_maxrss);
+#endif
+    }
+#endif
+    return -1;
+}
+
+// Measures what runs between start() and stop(), over ops operations
+class Measure
+{
+public:
+    void start()
+    {
+        resetPeakRss();
+        allocationsAtStart = allocations.load(std::memory_order_relaxed);
+        timer.start();
+    }
+
+    QJsonObject stop(const QString &name, quint64 targets, quint64 ops)
+    {
+        const qint64 elapsed = timer.nsecsElapsed();
+        const quint64 allocated = allocations.load(std::memory_order_relaxed) - allocationsAtStart;
+        QJsonObject result;
+        result["name"] = name;
+        result["targets"] = double(targets);
+        result["ops"] = double(ops);
+        result["ns_total"] = double(elapsed);
+        result["ns_per_op"] = ops ? double(elapsed) / double(ops) : 0.0;
+        result["allocations"] = double(allocated);
+        result["allocations_per_op"] = ops ? double(allocated) / double(ops) : 0.0;
+        result["peak_rss_kib"] = double(peakRss());
+        return result;
+    }
+
+private:
+    QElapsedTimer timer;
+    quint64 allocationsAtStart = 0;
+};
+
+// The scanner with the network replaced
+class NullFinder : public ThreadedFinder
+{
+public:
+    ProbeEngine *createProbeEngine() const override
+    {
+        return new NullProbeEngine;
+    }
+};
+
+// 10.0.0.0 and the next addresses, on a single port
+static QString addressRange(quint64 targets)
+{
+    const quint32 first = QHostAddress("10.0.0.0").toIPv4Address();
+    return QHostAddress(first).toString() + '-' + QHostAddress(first + quint32(targets - 1)).toString();
+}
+
+static QJsonObject benchmarkTargetGeneration(quint64 targets)
+{
+    AddressSet addresses;
+    addresses.insertList(addressRange(targets).toLatin1());
+    addresses.normalize();
+
+    Measure measure;
+    measure.start();
+    TargetGenerator generator(addresses, PortSet("8080"));
+    quint64 checksum = 0;
+    while (generator.hasNext()) {
+        const ScanTarget target = generator.next();
+        checksum += target.address.low() + target.port;
+    }
+    QJsonObject result = measure.stop("target_generation", targets, targets);
+    result["checksum"] = double(checksum % 1000000007);
+    return result;
+}
+
+// Dispatch, completion and progress, end to end: the checks are only
+// reachable through a whole scan
+static QJsonObject benchmarkScan(quint64 targets)
+{
+    NullFinder finder;
+    finder.setTargets(addressRange(targets));
+    finder.setPorts("8080");
+    finder.setAdaptiveConcurrency(false);
+    finder.setNumberOfThreads(10000);
+    finder.setRateLimit(0);
+    finder.setUseHostCache(false);
+    finder.setResumeScans(false);
+    finder.setConnectSweep(false);
+
+    quint64 progressSignals = 0;
+    QObject::connect(&finder, &ThreadedFinder::progressChanged, &finder, [&] {
+        progressSignals++;
+    }, Qt::DirectConnection);
+    quint64 replies = 0;
+    QObject::connect(&finder, &ThreadedFinder::checkReplied, &finder, [&] {
+        replies++;
+    }, Qt::DirectConnection);
+
+    QEventLoop loop;
+    QObject::connect(&finder, &QThread::finished, &loop, &QEventLoop::quit);
+
+    Measure measure;
+    measure.start();
+    finder.start();
+    loop.exec();
+    QJsonObject result = measure.stop("scan", targets, targets);
+    result["replies"] = double(replies);
+    result["progress_signals"] = double(progressSignals);
+    return result;
+}
+
+static void fillStore(ResultStore &store, quint64 targets)
+{
+    const quint32 first = QHostAddress("10.0.0.0").toIPv4Address();
+    for (quint64 i = 0; i < targets; ++i) {
+        const int error = i % 100 == 0 ? QNetworkReply::NoError
+                        : i % 7 == 0 ? QNetworkReply::OperationCanceledError : QNetworkReply::ConnectionRefusedError;
+        const ScanResult result = { IpAddress::fromIPv4(first + quint32(i)), 8080, error, QString(), 0, quint32(i % 5000), 0, BenchmarkResult() };
+        store.append(result);
+    }
+}
+
+static QJsonObject benchmarkResultStore(quint64 targets)
+{
+    ResultStore store;
+    store.setFilter(QSet<int>() << QNetworkReply::NoError);
+
+    Measure measure;
+    measure.start();
+    fillStore(store, targets);
+    return measure.stop("result_store", targets, targets);
+}
+
+// Filtering again and reading every row of the view, as the report does
+static QJsonObject benchmarkReportFilter(quint64 targets)
+{
+    ResultStore store;
+    fillStore(store, targets);
+    ReportModel model(&store);
+
+    Measure measure;
+    measure.start();
+    store.setFilter(QSet<int>() << QNetworkReply::NoError << QNetworkReply::ConnectionRefusedError);
+    model.refresh();
+    quint64 length = 0;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        length += quint64(model.data(model.index(row), ReportModel::HostNameRole).toString().size());
+    }
+    QJsonObject result = measure.stop("report_filter", targets, quint64(model.rowCount()));
+    result["rows"] = model.rowCount();
+    result["checksum"] = double(length);
+    return result;
+}
+
+static QJsonObject benchmarkReportSort(quint64 targets)
+{
+    ResultStore store;
+    fillStore(store, targets);
+    store.setFilter(QSet<int>() << QNetworkReply::NoError << QNetworkReply::ConnectionRefusedError);
+    ReportModel model(&store);
+    model.refresh();
+
+    Measure measure;
+    measure.start();
+    model.setSortRole(ReportModel::LatencyRole);
+    QJsonObject result = measure.stop("report_sort", targets, quint64(model.rowCount()));
+    result["rows"] = model.rowCount();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("proxyfinder-benchmarks");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the scanner hot paths, from --min to --max targets by powers of 10, as JSON.");
+    parser.addHelpOption();
+    const QCommandLineOption minOption("min", "Smallest number of targets.", "n", "1000");
+    const QCommandLineOption maxOption("max", "Largest number of targets.", "n", "10000000");
+    const QCommandLineOption casesOption("cases", "Cases to run: target_generation, scan, result_store, report_filter, report_sort.", "names",
+                                         "target_generation,scan,result_store,report_filter,report_sort");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "Write the JSON to <file> instead of the standard output.", "file");
+    parser.addOptions({ minOption, maxOption, casesOption, outputOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    bool minOk = false;
+    bool maxOk = false;
+    const quint64 minTargets = parser.value(minOption).toULongLong(&minOk);
+    const quint64 maxTargets = parser.value(maxOption).toULongLong(&maxOk);
+    // The targets are IPv4 addresses from 10.0.0.0 on
+    if (!minOk || !maxOk || minTargets == 0 || minTargets > maxTargets || maxTargets > 100000000) {
+        err << "Invalid range of targets: " << parser.value(minOption) << " to " << parser.value(maxOption) << endl;
+        return 1;
+    }
+
+    typedef QJsonObject (*Case)(quint64);
+    const QList<QPair<QString, Case>> allCases = {
+        { "target_generation", benchmarkTargetGeneration },
+        { "scan", benchmarkScan },
+        { "result_store", benchmarkResultStore },
+        { "report_filter", benchmarkReportFilter },
+        { "report_sort", benchmarkReportSort },
+    };
+    const QStringList selected = parser.value(casesOption).split(',', Qt::SkipEmptyParts);
+    for (const QString &name : selected) {
+        bool known = false;
+        for (const auto &benchmarkCase : allCases) {
+            known = known || benchmarkCase.first == name;
+        }
+        if (!known) {
+            err << "Unknown case: " << name << endl;
+            return 1;
+        }
+    }
+
+    QJsonArray results;
+    for (const auto &benchmarkCase : allCases) {
+        if (!selected.contains(benchmarkCase.first)) {
+            continue;
+        }
+        for (quint64 targets = minTargets; targets <= maxTargets; targets *= 10) {
+            const QJsonObject result = benchmarkCase.second(targets);
+            err << result["name"].toString() << ' ' << targets << ": " << result["ns_per_op"].toDouble() << " ns/op" << endl;
+            results.append(result);
+        }
+    }
+
+    QJsonObject report;
+    report["qt"] = QT_VERSION_STR;
+    report["benchmarks"] = results;
+    const QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            err << "Can't write " << parser.value(outputOption) << endl;
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
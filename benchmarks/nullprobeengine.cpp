@@ -0,0 +1,38 @@
+#include "nullprobeengine.h"
+#include <QMetaObject>
+#include <QNetworkReply>
+
+NullProbeEngine::NullProbeEngine(int hitEvery, QObject *parent) : ProbeEngine(parent), hitEvery(qMax(1, hitEvery))
+{
+}
+
+void NullProbeEngine::start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout)
+{
+    Q_UNUSED(timeout)
+    checks.append({ sequence, address, port });
+    // Replying right away would reenter the dispatch loop
+    if (!scheduled) {
+        scheduled = true;
+        QMetaObject::invokeMethod(this, [=] {
+            reply();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void NullProbeEngine::stop()
+{
+    checks.clear();
+}
+
+void NullProbeEngine::reply()
+{
+    scheduled = false;
+    // The checks started by the replies wait for the next pass
+    replying.swap(checks);
+    for (const Check &check : replying) {
+        const bool hit = ++started % quint64(hitEvery) == 0;
+        emit replied(check.sequence, check.address, check.port,
+                     hit ? QNetworkReply::NoError : QNetworkReply::ConnectionRefusedError, QString(), 0);
+    }
+    replying.clear();
+}
@@ -0,0 +1,37 @@
+#ifndef NULLPROBEENGINE_H
+#define NULLPROBEENGINE_H
+
+#include "../backend/ProbeEngine/probeengine.h"
+#include <QVector>
+
+// Answers every check on the next pass of the event loop, without touching
+// the network, so the benchmarks measure the scanner alone. One check in
+// hitEvery is answered as a working proxy, the others as refused.
+class NullProbeEngine : public ProbeEngine
+{
+    Q_OBJECT
+
+public:
+    explicit NullProbeEngine(int hitEvery = 100, QObject *parent = nullptr);
+
+public slots:
+    void start(quint64 sequence, const IpAddress &address, unsigned short port, int timeout = -1) override;
+    void stop() override;
+
+private:
+    struct Check {
+        quint64 sequence;
+        IpAddress address;
+        unsigned short port;
+    };
+
+    void reply();
+
+    int hitEvery = 100;
+    quint64 started = 0;
+    QVector<Check> checks;
+    QVector<Check> replying;
+    bool scheduled = false;
+};
+
+#endif // NULLPROBEENGINE_H
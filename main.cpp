@@ -8,20 +8,24 @@
 
 #include "backend/ThreadedFinder/threadedfinder.h"
 #include "backend/ApplicationManager/applicationmanager.h"
+#include "backend/CommandLineScanner/commandlinescanner.h"
 
+void setApplicationInfo(QCoreApplication &app);
+int runHeadless(int argc, char *argv[]);
 void load(Settings &s, ThreadedFinder &finder);
 void save(Settings &s, const ThreadedFinder &finder);
 
-//! TODO: Caught exceptions to allow saving even if the app crashes
-
 int main(int argc, char *argv[])
 {
+    // The headless mode needs neither a display nor the QML engine
+    if (CommandLineScanner::isHeadless(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 
     QGuiApplication app(argc, argv);
-    app.setOrganizationName("TheCrowporation");
-    app.setApplicationName("Proxy Finder");
-    app.setApplicationVersion("0.2-alpha");
+    setApplicationInfo(app);
     app.setWindowIcon(QIcon(":/images/appIcon.png"));
 
 #ifdef Q_OS_WIN
@@ -31,6 +35,7 @@ int main(int argc, char *argv[])
 #endif
 
     qmlRegisterType<ApplicationManager>("ProxyFinder", 0, 2, "ApplicationManager");
+    qmlRegisterUncreatableType<ReportModel>("ProxyFinder", 0, 2, "ReportModel", "The report model belongs to the finder");
 
     QQmlApplicationEngine engine;
     ThreadedFinder finder;
@@ -39,6 +44,12 @@ int main(int argc, char *argv[])
     QSettings::setDefaultFormat(QSettings::IniFormat);
     Settings s;
     load(s, finder);
+    finder.setCheckpointFile(settingsPath + "/scan.checkpoint");
+    finder.setHostCacheFile(settingsPath + "/hosts.cache");
+    // Saved when a scan starts too, so an interrupted scan can be resumed with the same settings
+    QObject::connect(&finder, &QThread::started, &s, [&] {
+        save(s, finder);
+    });
     engine.rootContext()->setContextProperty("finder", &finder);
     engine.load(QUrl(QStringLiteral("qrc:/ui/main.qml")));
     if (engine.rootObjects().isEmpty())
@@ -50,18 +61,64 @@ int main(int argc, char *argv[])
     return returnCode;
 }
 
+void setApplicationInfo(QCoreApplication &app)
+{
+    app.setOrganizationName("TheCrowporation");
+    app.setApplicationName("Proxy Finder");
+    app.setApplicationVersion("0.2-alpha");
+}
+
+int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    setApplicationInfo(app);
+
+    CommandLineScanner scanner;
+    if (!scanner.configure(app.arguments())) {
+        return 1;
+    }
+    QObject::connect(&scanner, &CommandLineScanner::finished, &app, &QCoreApplication::exit);
+    scanner.start();
+
+    return app.exec();
+}
+
 void load(Settings &s, ThreadedFinder &finder)
 {
     // Basic
     finder.setInitialAddressString(s.getInitialAddress());
     finder.setFinalAddressString(s.getFinalAddress());
-    finder.setPort(s.getPort());
+    finder.setTargets(s.getTargets());
+    finder.setTargetsFile(s.getTargetsFile());
+    finder.setPorts(s.getPorts());
 
     // Advanced
     finder.setTimeout(s.getTimeout());
+    finder.setMinTimeout(s.getMinTimeout());
+    finder.setAdaptiveTimeout(s.getAdaptiveTimeout());
+    finder.setConnectSweep(s.getConnectSweep());
+    finder.setConnectTimeout(s.getConnectTimeout());
+    finder.setResumeScans(s.getResumeScans());
+    finder.setUseHostCache(s.getUseHostCache());
+    finder.setLiveTtl(s.getLiveTtl());
+    finder.setRefusedTtl(s.getRefusedTtl());
+    finder.setDeadTtl(s.getDeadTtl());
+    finder.setBenchmark(s.getBenchmark());
+    finder.setBenchmarkSamples(s.getBenchmarkSamples());
+    finder.setJudgeUrl(s.getJudgeUrl());
     finder.setNumberOfThreads(s.getMaxThreads());
+    finder.setMinThreads(s.getMinThreads());
+    finder.setAdaptiveConcurrency(s.getAdaptiveConcurrency());
+    finder.setRateLimit(s.getRateLimit());
+    finder.setRateBurst(s.getRateBurst());
+    finder.setWorkerThreads(s.getWorkerThreads());
     finder.setRequestType(s.getRequestType());
     finder.setRequestUrl(s.getRequestUrl());
+    finder.setEngine(s.getEngine());
+
+    // Output
+    finder.setOutputFile(s.getOutputFile());
+    finder.setOutputFormat(s.getOutputFormat());
 }
 
 void save(Settings &s, const ThreadedFinder &finder)
@@ -73,11 +130,35 @@ void save(Settings &s, const ThreadedFinder &finder)
     // Basic
     s.setInitialAddress(finder.getInitialAddressString());
     s.setFinalAddress(finder.getFinalAddressString());
-    s.setPort(finder.getPort());
+    s.setTargets(finder.getTargets());
+    s.setTargetsFile(finder.getTargetsFile());
+    s.setPorts(finder.getPorts());
 
     // Advanced
     s.setTimeout(finder.getTimeout());
+    s.setMinTimeout(finder.getMinTimeout());
+    s.setAdaptiveTimeout(finder.getAdaptiveTimeout());
+    s.setConnectSweep(finder.getConnectSweep());
+    s.setConnectTimeout(finder.getConnectTimeout());
+    s.setResumeScans(finder.getResumeScans());
+    s.setUseHostCache(finder.getUseHostCache());
+    s.setLiveTtl(finder.getLiveTtl());
+    s.setRefusedTtl(finder.getRefusedTtl());
+    s.setDeadTtl(finder.getDeadTtl());
+    s.setBenchmark(finder.getBenchmark());
+    s.setBenchmarkSamples(finder.getBenchmarkSamples());
+    s.setJudgeUrl(finder.getJudgeUrl());
     s.setMaxThreads(finder.getNumberOfThreads());
+    s.setMinThreads(finder.getMinThreads());
+    s.setAdaptiveConcurrency(finder.getAdaptiveConcurrency());
+    s.setRateLimit(finder.getRateLimit());
+    s.setRateBurst(finder.getRateBurst());
+    s.setWorkerThreads(finder.getWorkerThreads());
     s.setRequestType(finder.getRequestType());
     s.setRequestUrl(finder.getRequestUrl());
+    s.setEngine(finder.getEngine());
+
+    // Output
+    s.setOutputFile(finder.getOutputFile());
+    s.setOutputFormat(finder.getOutputFormat());
 }
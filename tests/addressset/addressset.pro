@@ -0,0 +1,23 @@
+QT -= gui
+QT += network testlib
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_addressset
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+BACKEND = ../../backend
+
+HEADERS += \
+    $$BACKEND/IpAddress/ipaddress.h \
+    $$BACKEND/AddressSet/addressset.h \
+    $$BACKEND/PortSet/portset.h \
+    $$BACKEND/TargetGenerator/targetgenerator.h
+
+SOURCES += \
+    tst_addressset.cpp \
+    $$BACKEND/IpAddress/ipaddress.cpp \
+    $$BACKEND/AddressSet/addressset.cpp \
+    $$BACKEND/PortSet/portset.cpp \
+    $$BACKEND/TargetGenerator/targetgenerator.cpp
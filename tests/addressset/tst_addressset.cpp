@@ -0,0 +1,96 @@
+#include "../../backend/AddressSet/addressset.h"
+#include "../../backend/PortSet/portset.h"
+#include "../../backend/TargetGenerator/targetgenerator.h"
+#include <QtTest>
+#include <limits>
+
+class TestAddressSet : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void overlappingEntries_data();
+    void overlappingEntries();
+    void seekAcrossPatterns();
+    void targetCountSaturates();
+};
+
+static QStringList walk(AddressSet &set)
+{
+    QStringList produced;
+    set.rewind();
+    while (set.hasNext()) {
+        produced << set.next().toString();
+    }
+    return produced;
+}
+
+void TestAddressSet::overlappingEntries_data()
+{
+    QTest::addColumn<QByteArray>("entries");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("same pattern twice") << QByteArray("2001:db8::/63@::1-::2 2001:db8::/63@::1-::2")
+                                        << QStringList { "2001:db8::1", "2001:db8::2", "2001:db8:0:1::1", "2001:db8:0:1::2" };
+    QTest::newRow("overlapping suffixes") << QByteArray("2001:db8::/64@::1-::3 2001:db8::/64@::2-::5")
+                                          << QStringList { "2001:db8::1", "2001:db8::2", "2001:db8::3", "2001:db8::4", "2001:db8::5" };
+    QTest::newRow("nested prefixes") << QByteArray("2001:db8::/63@::1 2001:db8:0:1::/64@::1-::2")
+                                     << QStringList { "2001:db8::1", "2001:db8:0:1::1", "2001:db8:0:1::2" };
+    QTest::newRow("pattern and interval") << QByteArray("2001:db8::/63@::1-::3 2001:db8::2-4")
+                                          << QStringList { "2001:db8::2", "2001:db8::3", "2001:db8::4", "2001:db8::1", "2001:db8:0:1::1",
+                                                           "2001:db8:0:1::2", "2001:db8:0:1::3" };
+    QTest::newRow("pattern and address") << QByteArray("2001:db8:0:1::2 2001:db8::/63@::1-::2")
+                                         << QStringList { "2001:db8::1", "2001:db8::2", "2001:db8:0:1::1", "2001:db8:0:1::2" };
+}
+
+void TestAddressSet::overlappingEntries()
+{
+    QFETCH(QByteArray, entries);
+    QFETCH(QStringList, expected);
+
+    AddressSet set;
+    QCOMPARE(set.insertList(entries), 0);
+    set.normalize();
+
+    QStringList produced = walk(set);
+    QCOMPARE(set.size(), quint64(expected.count()));
+    QCOMPARE(produced.count(), expected.count());
+    produced.sort();
+    expected.sort();
+    QCOMPARE(produced, expected);
+    for (const QString &address : expected) {
+        QVERIFY(set.contains(IpAddress::fromHostAddress(QHostAddress(address))));
+    }
+}
+
+void TestAddressSet::seekAcrossPatterns()
+{
+    AddressSet set;
+    set.insertList("2001:db8::/62@::1-::3 2001:db8:0:1::/64@::2-::6 2001:db8::5-2001:db8::9");
+    set.normalize();
+    const QStringList all = walk(set);
+
+    for (int position = 0; position <= all.count(); ++position) {
+        set.seek(quint64(position));
+        QCOMPARE(set.remaining(), quint64(all.count() - position));
+        QStringList rest;
+        while (set.hasNext()) {
+            rest << set.next().toString();
+        }
+        QCOMPARE(rest, all.mid(position));
+    }
+}
+
+void TestAddressSet::targetCountSaturates()
+{
+    AddressSet set;
+    set.insertList("2001:db8::/32");
+    set.normalize();
+    const TargetGenerator generator(set, PortSet("80,8080"));
+    QCOMPARE(generator.size(), std::numeric_limits<quint64>::max());
+    QCOMPARE(generator.remaining(), std::numeric_limits<quint64>::max());
+}
+
+QTEST_APPLESS_MAIN(TestAddressSet)
+
+#include "tst_addressset.moc"
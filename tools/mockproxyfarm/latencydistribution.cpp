@@ -0,0 +1,80 @@
+#include "latencydistribution.h"
+#include <QStringList>
+#include <QRegExp>
+#include <algorithm>
+#include <cmath>
+
+// Delays past it would only hold the connections of the scan
+static const double MaximumLatency = 600000;
+
+LatencyDistribution::LatencyDistribution()
+{
+}
+
+bool LatencyDistribution::parse(const QString &description)
+{
+    const int colon = description.indexOf(':');
+    const QString name = description.left(colon).trimmed().toLower();
+    const QString arguments = colon < 0 ? QString() : description.mid(colon + 1);
+    const QStringList values = arguments.split(QRegExp("[-,]"));
+
+    double parsed[2] = { 0, 0 };
+    for (int i = 0; i < values.count() && i < 2; ++i) {
+        bool ok = false;
+        parsed[i] = values[i].trimmed().toDouble(&ok);
+        if (!ok || parsed[i] < 0) {
+            return false;
+        }
+    }
+
+    if (name == "fixed" && values.count() == 1) {
+        kind = Fixed;
+    } else if (name == "uniform" && values.count() == 2 && parsed[0] <= parsed[1]) {
+        kind = Uniform;
+    } else if (name == "exponential" && values.count() == 1 && parsed[0] > 0) {
+        kind = Exponential;
+    } else if (name == "lognormal" && values.count() == 2 && parsed[0] > 0) {
+        kind = LogNormal;
+    } else {
+        return false;
+    }
+    first = parsed[0];
+    second = parsed[1];
+    return true;
+}
+
+QString LatencyDistribution::toString() const
+{
+    switch (kind) {
+    case Uniform:
+        return QString("uniform:%1-%2").arg(first).arg(second);
+    case Exponential:
+        return QString("exponential:%1").arg(first);
+    case LogNormal:
+        return QString("lognormal:%1,%2").arg(first).arg(second);
+    case Fixed:
+    default:
+        return QString("fixed:%1").arg(first);
+    }
+}
+
+int LatencyDistribution::sample(std::mt19937_64 &generator) const
+{
+    double value;
+    switch (kind) {
+    case Uniform:
+        value = std::uniform_real_distribution<double>(first, second)(generator);
+        break;
+    case Exponential:
+        value = std::exponential_distribution<double>(1 / first)(generator);
+        break;
+    case LogNormal:
+        // The median of a log-normal distribution is exp(mu)
+        value = std::lognormal_distribution<double>(std::log(first), second)(generator);
+        break;
+    case Fixed:
+    default:
+        value = first;
+    }
+    return int(std::min(value, MaximumLatency) + 0.5);
+}
@@ -0,0 +1,30 @@
+#ifndef LATENCYDISTRIBUTION_H
+#define LATENCYDISTRIBUTION_H
+
+#include <QString>
+#include <random>
+
+// Delay before the mock proxies answer, in milliseconds, written as one of:
+//  fixed:<ms>
+//  uniform:<min>-<max>
+//  exponential:<mean>
+//  lognormal:<median>,<sigma>   the long tail of real proxies
+class LatencyDistribution
+{
+public:
+    LatencyDistribution();
+
+    bool parse(const QString &description);
+    QString toString() const;
+
+    int sample(std::mt19937_64 &generator) const;
+
+private:
+    enum Kind { Fixed, Uniform, Exponential, LogNormal };
+
+    Kind kind = Fixed;
+    double first = 0;
+    double second = 0;
+};
+
+#endif // LATENCYDISTRIBUTION_H
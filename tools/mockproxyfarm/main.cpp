@@ -0,0 +1,160 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QTimer>
+
+#include "proxyfarm.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// Every listener and every connection takes a descriptor
+static void raiseDescriptorLimit()
+{
+#ifdef Q_OS_UNIX
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+static bool parseMix(const QString &mix, ProxyFarm &farm)
+{
+    for (int i = 0; i < ProxyFarm::BehaviorCount; ++i) {
+        farm.setWeight(ProxyFarm::Behavior(i), 0);
+    }
+    for (const QString &entry : mix.split(',', Qt::SkipEmptyParts)) {
+        const int equals = entry.indexOf('=');
+        const int behavior = ProxyFarm::behaviorFromName(entry.left(equals).trimmed());
+        bool ok = false;
+        const int weight = entry.mid(equals + 1).toInt(&ok);
+        if (equals < 0 || behavior < 0 || !ok || weight < 0) {
+            return false;
+        }
+        farm.setWeight(ProxyFarm::Behavior(behavior), weight);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mockproxyfarm");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Fake proxies on thousands of loopback addresses, to scan at scale without any outside network.\n"
+                                     "Linux routes the whole 127.0.0.0/8 to the loopback interface; other systems need the addresses aliased first.\n"
+                                     "Behaviors: working, auth (407 or refused SOCKS methods), blackhole (never answers),\n"
+                                     "reset, slow (answers after the slow delay) and refused (not listened on).");
+    parser.addHelpOption();
+    const QCommandLineOption baseOption("base", "First address of the farm.", "address", "127.1.0.1");
+    const QCommandLineOption hostsOption("hosts", "Number of consecutive addresses.", "n", "1024");
+    const QCommandLineOption portsOption(QStringList() << "p" << "ports", "Ports of every address, as in 80,3128,8000-8100.", "ports", "8080");
+    const QCommandLineOption mixOption("mix", "Relative weights of the behaviors.", "weights", "working=20,auth=5,blackhole=25,reset=10,slow=5,refused=35");
+    const QCommandLineOption latencyOption("latency", "Delay of the answers in ms: fixed:<ms>, uniform:<min>-<max>, exponential:<mean> or lognormal:<median>,<sigma>.",
+                                           "distribution", "lognormal:80,0.6");
+    const QCommandLineOption slowOption("slow", "Extra delay of the slow proxies, in milliseconds.", "ms", "5000");
+    const QCommandLineOption bodyOption("body", "Size of the pages served through the working proxies, in bytes.", "bytes", "1024");
+    const QCommandLineOption seedOption("seed", "Seed of the behaviors and the delays; the same seed builds the same farm.", "n", "1");
+    const QCommandLineOption manifestOption("manifest", "Write every address:port and its behavior to <file>, to check the scan results against.", "file");
+    const QCommandLineOption statsOption("stats", "Print the connections accepted every <s> seconds, 0 never.", "s", "10");
+    parser.addOptions({ baseOption, hostsOption, portsOption, mixOption, latencyOption, slowOption, bodyOption, seedOption, manifestOption, statsOption });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    ProxyFarm farm;
+
+    QHostAddress base;
+    bool isIPv4 = false;
+    const quint32 baseAddress = base.setAddress(parser.value(baseOption)) ? base.toIPv4Address(&isIPv4) : 0;
+    if (!isIPv4) {
+        err << "Invalid base address: " << parser.value(baseOption) << endl;
+        return 1;
+    }
+    farm.setBaseAddress(baseAddress);
+
+    bool ok = false;
+    const int hosts = parser.value(hostsOption).toInt(&ok);
+    if (!ok || hosts <= 0 || quint64(baseAddress) + quint64(hosts) > 0x80000000ULL) {
+        err << "Invalid number of hosts: " << parser.value(hostsOption) << endl;
+        return 1;
+    }
+    farm.setHosts(hosts);
+
+    const PortSet ports(parser.value(portsOption));
+    if (!ports.isValid() || ports.isEmpty()) {
+        err << "Invalid ports: " << parser.value(portsOption) << endl;
+        return 1;
+    }
+    farm.setPorts(ports);
+
+    if (!parseMix(parser.value(mixOption), farm)) {
+        err << "Invalid mix: " << parser.value(mixOption) << endl;
+        return 1;
+    }
+
+    LatencyDistribution latency;
+    if (!latency.parse(parser.value(latencyOption))) {
+        err << "Invalid latency distribution: " << parser.value(latencyOption) << endl;
+        return 1;
+    }
+    farm.setLatency(latency);
+
+    const int slow = parser.value(slowOption).toInt(&ok);
+    if (!ok || slow < 0) {
+        err << "Invalid slow delay: " << parser.value(slowOption) << endl;
+        return 1;
+    }
+    farm.setSlowDelay(slow);
+
+    const int body = parser.value(bodyOption).toInt(&ok);
+    if (!ok || body < 0) {
+        err << "Invalid body size: " << parser.value(bodyOption) << endl;
+        return 1;
+    }
+    farm.setBodySize(body);
+
+    const quint64 seed = parser.value(seedOption).toULongLong(&ok);
+    if (!ok) {
+        err << "Invalid seed: " << parser.value(seedOption) << endl;
+        return 1;
+    }
+    farm.setSeed(seed);
+
+    const int stats = parser.value(statsOption).toInt(&ok);
+    if (!ok || stats < 0) {
+        err << "Invalid statistics interval: " << parser.value(statsOption) << endl;
+        return 1;
+    }
+
+    if (parser.isSet(manifestOption) && !farm.writeManifest(parser.value(manifestOption))) {
+        err << "Can't write the manifest to " << parser.value(manifestOption) << endl;
+        return 1;
+    }
+
+    raiseDescriptorLimit();
+    QString error;
+    if (!farm.start(&error)) {
+        err << "Can't listen on " << error << endl;
+        return 1;
+    }
+
+    err << "Listening on " << base.toString() << '-' << QHostAddress(baseAddress + quint32(hosts - 1)).toString()
+        << ", ports " << ports.toString() << ", latency " << latency.toString() << endl;
+    for (int i = 0; i < ProxyFarm::BehaviorCount; ++i) {
+        err << "  " << ProxyFarm::behaviorName(i) << ": " << farm.listenerCount(ProxyFarm::Behavior(i)) << endl;
+    }
+
+    QTimer statistics;
+    if (stats > 0) {
+        QObject::connect(&statistics, &QTimer::timeout, &farm, [&] {
+            QTextStream(stderr) << farm.statistics() << endl;
+        });
+        statistics.start(stats * 1000);
+    }
+
+    return app.exec();
+}
@@ -0,0 +1,19 @@
+QT -= gui
+QT += network
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = mockproxyfarm
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+HEADERS += \
+    latencydistribution.h \
+    proxyfarm.h \
+    ../../backend/PortSet/portset.h
+
+SOURCES += \
+    main.cpp \
+    latencydistribution.cpp \
+    proxyfarm.cpp \
+    ../../backend/PortSet/portset.cpp
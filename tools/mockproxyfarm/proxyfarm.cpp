@@ -0,0 +1,376 @@
+#include "proxyfarm.h"
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#endif
+
+static const int MaximumRequest = 64 * 1024;
+
+static const char *const BehaviorNames[ProxyFarm::BehaviorCount] = { "working", "auth", "blackhole", "reset", "slow", "refused" };
+
+// splitmix64, so the behavior of a target depends on nothing but the seed
+static quint64 mix(quint64 value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+static QString addressToString(quint32 address)
+{
+    return QHostAddress(address).toString();
+}
+
+ProxyFarm::ProxyFarm(QObject *parent) : QObject(parent), baseAddress(QHostAddress("127.1.0.1").toIPv4Address()), ports("8080")
+{
+    const int defaultWeights[BehaviorCount] = { 20, 5, 25, 10, 5, 35 };
+    for (int i = 0; i < BehaviorCount; ++i) {
+        weights[i] = defaultWeights[i];
+        listeners[i] = 0;
+        accepted[i] = 0;
+    }
+    latency.parse("lognormal:80,0.6");
+}
+
+void ProxyFarm::setBaseAddress(quint32 address)
+{
+    baseAddress = address;
+}
+
+void ProxyFarm::setHosts(int count)
+{
+    hosts = count;
+}
+
+void ProxyFarm::setPorts(const PortSet &portSet)
+{
+    ports = portSet;
+}
+
+void ProxyFarm::setWeight(Behavior behavior, int weight)
+{
+    weights[behavior] = qMax(0, weight);
+}
+
+void ProxyFarm::setLatency(const LatencyDistribution &distribution)
+{
+    latency = distribution;
+}
+
+void ProxyFarm::setSlowDelay(int milliseconds)
+{
+    slowDelay = milliseconds;
+}
+
+void ProxyFarm::setBodySize(int bytes)
+{
+    bodySize = bytes;
+}
+
+void ProxyFarm::setSeed(quint64 value)
+{
+    seed = value;
+}
+
+bool ProxyFarm::start(QString *error)
+{
+    generator.seed(seed);
+    for (int i = 0; i < hosts; ++i) {
+        const quint32 address = baseAddress + quint32(i);
+        for (int j = 0; j < ports.count(); ++j) {
+            const unsigned short port = ports.at(j);
+            const Behavior behavior = behaviorOf(address, port);
+            listeners[behavior]++;
+            if (behavior == Refused) {
+                continue;
+            }
+
+            QTcpServer *server = new QTcpServer(this);
+            if (!server->listen(QHostAddress(address), port)) {
+                *error = addressToString(address) + ':' + QString::number(port) + ": " + server->errorString();
+                return false;
+            }
+            connect(server, &QTcpServer::newConnection, this, [=] {
+                onNewConnection(server, behavior);
+            });
+            servers.append(server);
+        }
+    }
+    return true;
+}
+
+bool ProxyFarm::writeManifest(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream stream(&file);
+    for (int i = 0; i < hosts; ++i) {
+        const quint32 address = baseAddress + quint32(i);
+        const QString host = addressToString(address) + ':';
+        for (int j = 0; j < ports.count(); ++j) {
+            stream << host << ports.at(j) << '\t' << BehaviorNames[behaviorOf(address, ports.at(j))] << '\n';
+        }
+    }
+    stream.flush();
+    return file.error() == QFile::NoError;
+}
+
+ProxyFarm::Behavior ProxyFarm::behaviorOf(quint32 address, unsigned short port) const
+{
+    quint64 total = 0;
+    for (int weight : weights) {
+        total += quint64(weight);
+    }
+    if (total == 0) {
+        return Refused;
+    }
+    quint64 draw = mix(seed ^ (quint64(address) << 16 | port)) % total;
+    for (int i = 0; i < BehaviorCount; ++i) {
+        if (draw < quint64(weights[i])) {
+            return Behavior(i);
+        }
+        draw -= quint64(weights[i]);
+    }
+    return Refused;
+}
+
+QString ProxyFarm::behaviorName(int behavior)
+{
+    return behavior >= 0 && behavior < BehaviorCount ? QString(BehaviorNames[behavior]) : QString();
+}
+
+int ProxyFarm::behaviorFromName(const QString &name)
+{
+    for (int i = 0; i < BehaviorCount; ++i) {
+        if (name == BehaviorNames[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ProxyFarm::listenerCount(Behavior behavior) const
+{
+    return listeners[behavior];
+}
+
+QString ProxyFarm::statistics() const
+{
+    QStringList counts;
+    for (int i = 0; i < BehaviorCount; ++i) {
+        if (i != Refused) {
+            counts << QString("%1 %2").arg(accepted[i]).arg(BehaviorNames[i]);
+        }
+    }
+    return "Accepted " + counts.join(", ") + "; answered " + QString::number(answered);
+}
+
+void ProxyFarm::onNewConnection(QTcpServer *server, Behavior behavior)
+{
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        accepted[behavior]++;
+        QSharedPointer<Connection> connection(new Connection);
+        connection->behavior = behavior;
+        connect(socket, &QTcpSocket::readyRead, this, [=] {
+            onReadyRead(socket, connection);
+        });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void ProxyFarm::onReadyRead(QTcpSocket *socket, const QSharedPointer<Connection> &connection)
+{
+    connection->buffer += socket->readAll();
+
+    switch (connection->behavior) {
+    case BlackHole:
+        connection->buffer.clear();
+        return;
+    case Reset:
+        if (!connection->answering) {
+            connection->answering = true;
+            QTimer::singleShot(delay(Reset), socket, [=] {
+                reset(socket);
+            });
+        }
+        return;
+    default:
+        break;
+    }
+
+    // One answer at a time, pipelined requests wait for it
+    if (connection->answering) {
+        return;
+    }
+    const int length = completeRequest(connection.data());
+    if (length < 0) {
+        reset(socket);
+        return;
+    }
+    if (length == 0) {
+        // Nothing a client would send before the end of its request
+        if (connection->buffer.size() > MaximumRequest) {
+            reset(socket);
+        }
+        return;
+    }
+    const QByteArray request = connection->buffer.left(length);
+    connection->buffer.remove(0, length);
+    connection->answering = true;
+
+    QTimer::singleShot(delay(connection->behavior), socket, [=] {
+        const QByteArray reply = answer(connection.data(), request);
+        connection->answering = false;
+        if (reply.isEmpty()) {
+            reset(socket);
+            return;
+        }
+        answered++;
+        socket->write(reply);
+        // The refusals end the connection, as the real servers do
+        if (connection->behavior == AuthRequired && connection->protocol != Http) {
+            socket->disconnectFromHost();
+            return;
+        }
+        if (!connection->buffer.isEmpty()) {
+            onReadyRead(socket, connection);
+        }
+    });
+}
+
+int ProxyFarm::completeRequest(const Connection *connection) const
+{
+    const QByteArray &buffer = connection->buffer;
+    if (buffer.isEmpty()) {
+        return 0;
+    }
+    Protocol protocol = connection->protocol;
+    if (protocol == UnknownProtocol) {
+        protocol = buffer[0] == '\x05' ? Socks5 : buffer[0] == '\x04' ? Socks4 : Http;
+    }
+    if (connection->tunneled) {
+        protocol = Http;
+    }
+
+    switch (protocol) {
+    case Socks5:
+        if (!connection->greeted) {
+            // Version, number of methods and the methods
+            return buffer.size() >= 2 && buffer.size() >= 2 + quint8(buffer[1]) ? 2 + quint8(buffer[1]) : 0;
+        }
+        if (buffer.size() < 5) {
+            return 0;
+        }
+        switch (buffer[3]) {
+        case '\x01': return buffer.size() >= 10 ? 10 : 0;
+        case '\x03': return buffer.size() >= 7 + quint8(buffer[4]) ? 7 + quint8(buffer[4]) : 0;
+        case '\x04': return buffer.size() >= 22 ? 22 : 0;
+        default: return -1;
+        }
+    case Socks4: {
+        // Port, address and user id, and the host name after it for SOCKS4a
+        const int userEnd = buffer.size() >= 8 ? buffer.indexOf('\0', 8) : -1;
+        if (userEnd < 0) {
+            return 0;
+        }
+        const bool socks4a = buffer[4] == '\0' && buffer[5] == '\0' && buffer[6] == '\0' && buffer[7] != '\0';
+        if (!socks4a) {
+            return userEnd + 1;
+        }
+        const int hostEnd = buffer.indexOf('\0', userEnd + 1);
+        return hostEnd < 0 ? 0 : hostEnd + 1;
+    }
+    default: {
+        // TLS through a tunnel can't be served
+        if (connection->tunneled && buffer[0] == '\x16') {
+            return -1;
+        }
+        const int end = buffer.indexOf("\r\n\r\n");
+        return end < 0 ? 0 : end + 4;
+    }
+    }
+}
+
+QByteArray ProxyFarm::answer(Connection *connection, const QByteArray &request)
+{
+    if (connection->tunneled) {
+        return originResponse(request);
+    }
+    if (connection->protocol == UnknownProtocol) {
+        connection->protocol = request[0] == '\x05' ? Socks5 : request[0] == '\x04' ? Socks4 : Http;
+    }
+    const bool working = connection->behavior != AuthRequired;
+
+    switch (connection->protocol) {
+    case Socks5:
+        if (!connection->greeted) {
+            if (!working || !request.mid(2).contains('\0')) {
+                return QByteArray("\x05\xFF", 2);
+            }
+            connection->greeted = true;
+            return QByteArray("\x05\x00", 2);
+        }
+        connection->tunneled = true;
+        return QByteArray("\x05\x00\x00\x01\x00\x00\x00\x00\x00\x00", 10);
+    case Socks4:
+        if (!working) {
+            return QByteArray("\x00\x5B\x00\x00\x00\x00\x00\x00", 8);
+        }
+        connection->tunneled = true;
+        return QByteArray("\x00\x5A\x00\x00\x00\x00\x00\x00", 8);
+    default:
+        break;
+    }
+
+    if (!working) {
+        return "HTTP/1.1 407 Proxy Authentication Required\r\n"
+               "Proxy-Authenticate: Basic realm=\"mockproxyfarm\"\r\n"
+               "Content-Length: 0\r\n\r\n";
+    }
+    if (request.startsWith("CONNECT ")) {
+        connection->tunneled = true;
+        return "HTTP/1.1 200 Connection established\r\n\r\n";
+    }
+    if (!request.startsWith("GET ") && !request.startsWith("HEAD ")) {
+        return "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\n\r\n";
+    }
+    return originResponse(request);
+}
+
+QByteArray ProxyFarm::originResponse(const QByteArray &request) const
+{
+    // The request headers, as the judges print them, padded to the body size
+    QByteArray body = request;
+    if (body.size() < bodySize) {
+        body += QByteArray(bodySize - body.size(), '.');
+    }
+    QByteArray response = "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain\r\n"
+                          "Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n";
+    if (!request.startsWith("HEAD ")) {
+        response += body;
+    }
+    return response;
+}
+
+void ProxyFarm::reset(QTcpSocket *socket)
+{
+#ifdef Q_OS_UNIX
+    // A zero linger time makes the close send a RST
+    const struct linger linger = { 1, 0 };
+    setsockopt(int(socket->socketDescriptor()), SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+#endif
+    socket->abort();
+    socket->deleteLater();
+}
+
+int ProxyFarm::delay(Behavior behavior)
+{
+    const int sample = latency.sample(generator);
+    return behavior == Slow ? slowDelay + sample : sample;
+}
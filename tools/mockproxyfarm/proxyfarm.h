@@ -0,0 +1,95 @@
+#ifndef PROXYFARM_H
+#define PROXYFARM_H
+
+#include "latencydistribution.h"
+#include "../../backend/PortSet/portset.h"
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QVector>
+#include <QTimer>
+#include <QSharedPointer>
+#include <random>
+
+// Thousands of fake proxies on loopback addresses, 127.x.y.z, so scans can
+// run end to end at scale without any outside network. Every address and
+// port gets one behavior, drawn from the mix with a seeded hash so the same
+// options always build the same farm:
+//  - working proxies answer HTTP forward requests, CONNECT, SOCKS4 and SOCKS5,
+//    and serve the tunneled HTTP requests themselves, echoing the headers
+//  - auth proxies answer 407, or refuse the SOCKS methods
+//  - black holes accept the connection and never answer
+//  - resetters reset the connection once the request arrives
+//  - slow proxies work, but answer after the slow delay
+//  - refused targets aren't listened on at all
+// Answers wait for a delay drawn from the latency distribution.
+class ProxyFarm : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Behavior { Working, AuthRequired, BlackHole, Reset, Slow, Refused, BehaviorCount };
+
+    explicit ProxyFarm(QObject *parent = nullptr);
+
+    void setBaseAddress(quint32 address);
+    void setHosts(int count);
+    void setPorts(const PortSet &portSet);
+    // Relative weights, by behavior
+    void setWeight(Behavior behavior, int weight);
+    void setLatency(const LatencyDistribution &distribution);
+    // In milliseconds
+    void setSlowDelay(int milliseconds);
+    void setBodySize(int bytes);
+    void setSeed(quint64 value);
+
+    // Returns false if a single listener can't be opened
+    bool start(QString *error);
+    // host:port and the behavior, one per line
+    bool writeManifest(const QString &fileName) const;
+    Behavior behaviorOf(quint32 address, unsigned short port) const;
+
+    static QString behaviorName(int behavior);
+    static int behaviorFromName(const QString &name);
+
+    int listenerCount(Behavior behavior) const;
+    QString statistics() const;
+
+private:
+    enum Protocol { UnknownProtocol, Http, Socks4, Socks5 };
+
+    struct Connection {
+        Behavior behavior = Working;
+        Protocol protocol = UnknownProtocol;
+        bool greeted = false; // SOCKS5 methods negotiated
+        bool tunneled = false; // what follows goes to the origin server
+        bool answering = false;
+        QByteArray buffer;
+    };
+
+    void onNewConnection(QTcpServer *server, Behavior behavior);
+    void onReadyRead(QTcpSocket *socket, const QSharedPointer<Connection> &connection);
+    int completeRequest(const Connection *connection) const;
+    QByteArray answer(Connection *connection, const QByteArray &request);
+    QByteArray originResponse(const QByteArray &request) const;
+    void reset(QTcpSocket *socket);
+    int delay(Behavior behavior);
+
+    quint32 baseAddress;
+    int hosts = 1024;
+    PortSet ports;
+    int weights[BehaviorCount];
+    LatencyDistribution latency;
+    int slowDelay = 5000;
+    int bodySize = 1024;
+    quint64 seed = 1;
+    std::mt19937_64 generator;
+
+    QVector<QTcpServer *> servers;
+    int listeners[BehaviorCount];
+    quint64 accepted[BehaviorCount];
+    quint64 answered = 0;
+};
+
+#endif // PROXYFARM_H
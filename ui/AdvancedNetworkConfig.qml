@@ -6,11 +6,31 @@ Dialog {
     id: root
 
     property alias maxThreads: spinBoxMaxThreads.value
+    property alias minThreads: spinBoxMinThreads.value
+    property alias adaptiveConcurrency: checkBoxAdaptiveConcurrency.checked
+    property alias rateLimit: spinBoxRateLimit.value
+    property alias rateBurst: spinBoxRateBurst.value
+    property alias workerThreads: spinBoxWorkerThreads.value
     property alias timeout: spinBoxTimeout.value
+    property alias minTimeout: spinBoxMinTimeout.value
+    property alias adaptiveTimeout: checkBoxAdaptiveTimeout.checked
+    property alias connectSweep: checkBoxConnectSweep.checked
+    property alias connectTimeout: spinBoxConnectTimeout.value
     property alias requestType: comboBoxRequestType.currentIndex
     property alias requestUrl: textFieldRequestUrl.text
+    property alias engine: comboBoxEngine.currentIndex
+    property alias outputFile: textFieldOutputFile.text
+    property alias outputFormat: comboBoxOutputFormat.currentIndex
+    property alias resumeScans: checkBoxResumeScans.checked
+    property alias useHostCache: checkBoxUseHostCache.checked
+    property alias liveTtl: spinBoxLiveTtl.value
+    property alias refusedTtl: spinBoxRefusedTtl.value
+    property alias deadTtl: spinBoxDeadTtl.value
+    property alias benchmark: checkBoxBenchmark.checked
+    property alias benchmarkSamples: spinBoxBenchmarkSamples.value
+    property alias judgeUrl: textFieldJudgeUrl.text
 
-    enum RequestType { HTTP, HTTPS, FTP }
+    enum RequestType { HTTP, HTTPS, FTP, Detect }
 
     title: qsTr("Advanced network options")
 
@@ -40,16 +60,72 @@ Dialog {
             }
         } // ColumnLayout
 
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            CheckBox {
+                id: checkBoxAdaptiveTimeout
+                text: qsTr("Adapt to the RTT, from (ms)")
+                checked: appManager.settings.adaptiveTimeout
+                padding: 0
+
+                onCheckedChanged: {
+                    finder.adaptiveTimeout = checked
+                }
+            }
+            SpinBox {
+                id: spinBoxMinTimeout
+                editable: true
+                enabled: checkBoxAdaptiveTimeout.checked
+                from: 10
+                to: spinBoxTimeout.value
+                value: appManager.settings.minTimeout
+                stepSize: 50
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.minTimeout = value
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            CheckBox {
+                id: checkBoxConnectSweep
+                text: qsTr("Connect first (ms)")
+                checked: appManager.settings.connectSweep
+                padding: 0
+
+                onCheckedChanged: {
+                    finder.connectSweep = checked
+                }
+            }
+            SpinBox {
+                id: spinBoxConnectTimeout
+                editable: true
+                enabled: checkBoxConnectSweep.checked
+                from: 50
+                to: 10000
+                value: appManager.settings.connectTimeout
+                stepSize: 50
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.connectTimeout = value
+                }
+            }
+        } // ColumnLayout
+
         ColumnLayout {
             Layout.alignment: Qt.AlignTop
             Label {
-                text: qsTr("Max threads")
+                text: qsTr("Max concurrent checks")
             }
             SpinBox {
                 id: spinBoxMaxThreads
                 editable: true
                 from: 1
-                to: 1000
+                to: 100000
                 value: appManager.settings.maxThreads
                 stepSize: 100
                 Layout.fillWidth: true
@@ -60,6 +136,101 @@ Dialog {
             }
         } // ColumnLayout
 
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            CheckBox {
+                id: checkBoxAdaptiveConcurrency
+                text: qsTr("Adapt, from at least")
+                checked: appManager.settings.adaptiveConcurrency
+                padding: 0
+
+                onCheckedChanged: {
+                    finder.adaptiveConcurrency = checked
+                }
+            }
+            SpinBox {
+                id: spinBoxMinThreads
+                editable: true
+                enabled: checkBoxAdaptiveConcurrency.checked
+                from: 1
+                to: spinBoxMaxThreads.value
+                value: appManager.settings.minThreads
+                stepSize: 10
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.minThreads = value
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Rate limit") + " <i>" + qsTr("(checks/s)") + "</i>"
+            }
+            SpinBox {
+                id: spinBoxRateLimit
+                editable: true
+                from: 0
+                to: 1000000
+                value: appManager.settings.rateLimit
+                stepSize: 100
+                textFromValue: function(value, locale) {
+                    return value === 0 ? qsTr("Unlimited") : Number(value).toLocaleString(locale, 'f', 0)
+                }
+                valueFromText: function(text, locale) {
+                    return text === qsTr("Unlimited") ? 0 : Number.fromLocaleString(locale, text)
+                }
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.rateLimit = value
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Burst") + " <i>" + qsTr("(checks)") + "</i>"
+            }
+            SpinBox {
+                id: spinBoxRateBurst
+                editable: true
+                enabled: spinBoxRateLimit.value > 0
+                from: 1
+                to: 100000
+                value: appManager.settings.rateBurst
+                stepSize: 10
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.rateBurst = value
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Worker threads")
+            }
+            SpinBox {
+                id: spinBoxWorkerThreads
+                editable: true
+                from: 1
+                to: 256
+                value: appManager.settings.workerThreads
+                stepSize: 1
+                Layout.fillWidth: true
+
+                onValueChanged: {
+                    finder.workerThreads = value
+                }
+            }
+        } // ColumnLayout
+
         ColumnLayout {
             Layout.alignment: Qt.AlignTop
             Label {
@@ -67,7 +238,7 @@ Dialog {
             }
             ComboBox {
                 id: comboBoxRequestType
-                model: ["HTTP", "HTTPS", "FTP"]
+                model: ["HTTP", "HTTPS", "FTP", qsTr("Detect")]
                 currentIndex: appManager.settings.requestType
                 Layout.fillWidth: true
 
@@ -83,7 +254,8 @@ Dialog {
             }
             RowLayout {
                 Label {
-                    text: comboBoxRequestType.currentText.toLowerCase() + "://"
+                    // Detection requests the URL over HTTP, or tunnels to it
+                    text: (comboBoxRequestType.currentIndex === AdvancedNetworkConfig.RequestType.Detect ? "http" : comboBoxRequestType.currentText.toLowerCase()) + "://"
                     enabled: false
                 }
                 CustomTextField {
@@ -99,5 +271,186 @@ Dialog {
                 }
             }
         } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Engine")
+            }
+            ComboBox {
+                id: comboBoxEngine
+                model: [qsTr("Qt Network"), qsTr("Native (epoll)")]
+                enabled: appManager.settings.operatingSystem === "Linux"
+                currentIndex: appManager.settings.engine
+                Layout.fillWidth: true
+
+                onCurrentIndexChanged: {
+                    finder.engine = currentIndex
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Results file") + " <i>" + qsTr("(appended while scanning)") + "</i>"
+            }
+            RowLayout {
+                CustomTextField {
+                    id: textFieldOutputFile
+                    placeholderText: qsTr("None")
+                    text: appManager.settings.outputFile
+                    selectByMouse: true
+                    Layout.fillWidth: true
+
+                    onTextChanged: {
+                        finder.outputFile = text.trim()
+                    }
+                }
+                ComboBox {
+                    id: comboBoxOutputFormat
+                    model: ["NDJSON", "CSV"]
+                    currentIndex: appManager.settings.outputFormat
+
+                    onCurrentIndexChanged: {
+                        finder.outputFormat = currentIndex
+                    }
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Interrupted scans")
+            }
+            CheckBox {
+                id: checkBoxResumeScans
+                text: qsTr("Resume where they stopped")
+                checked: appManager.settings.resumeScans
+                padding: 0
+
+                onCheckedChanged: {
+                    finder.resumeScans = checked
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Known hosts")
+            }
+            CheckBox {
+                id: checkBoxUseHostCache
+                text: qsTr("Skip hosts known from previous scans")
+                checked: appManager.settings.useHostCache
+                padding: 0
+
+                onCheckedChanged: {
+                    finder.useHostCache = checked
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            enabled: checkBoxUseHostCache.checked
+            Label {
+                text: qsTr("Remember for") + " <i>" + qsTr("(min: live, refused, dead)") + "</i>"
+            }
+            RowLayout {
+                SpinBox {
+                    id: spinBoxLiveTtl
+                    editable: true
+                    from: 1
+                    to: 10080
+                    value: appManager.settings.liveTtl
+                    stepSize: 60
+                    Layout.fillWidth: true
+
+                    onValueChanged: {
+                        finder.liveTtl = value
+                    }
+                }
+                SpinBox {
+                    id: spinBoxRefusedTtl
+                    editable: true
+                    from: 1
+                    to: 10080
+                    value: appManager.settings.refusedTtl
+                    stepSize: 60
+                    Layout.fillWidth: true
+
+                    onValueChanged: {
+                        finder.refusedTtl = value
+                    }
+                }
+                SpinBox {
+                    id: spinBoxDeadTtl
+                    editable: true
+                    from: 1
+                    to: 10080
+                    value: appManager.settings.deadTtl
+                    stepSize: 10
+                    Layout.fillWidth: true
+
+                    onValueChanged: {
+                        finder.deadTtl = value
+                    }
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            Label {
+                text: qsTr("Proxies found") + " <i>" + qsTr("(samples)") + "</i>"
+            }
+            RowLayout {
+                CheckBox {
+                    id: checkBoxBenchmark
+                    text: qsTr("Benchmark them")
+                    checked: appManager.settings.benchmark
+                    padding: 0
+
+                    onCheckedChanged: {
+                        finder.benchmark = checked
+                    }
+                }
+                SpinBox {
+                    id: spinBoxBenchmarkSamples
+                    enabled: checkBoxBenchmark.checked
+                    editable: true
+                    from: 1
+                    to: 20
+                    value: appManager.settings.benchmarkSamples
+                    Layout.fillWidth: true
+
+                    onValueChanged: {
+                        finder.benchmarkSamples = value
+                    }
+                }
+            }
+        } // ColumnLayout
+
+        ColumnLayout {
+            Layout.alignment: Qt.AlignTop
+            enabled: checkBoxBenchmark.checked
+            Label {
+                text: qsTr("Anonymity judge") + " <i>" + qsTr("(echoes the request headers)") + "</i>"
+            }
+            CustomTextField {
+                id: textFieldJudgeUrl
+                placeholderText: "http://azenv.net/"
+                text: appManager.settings.judgeUrl
+                selectByMouse: true
+                Layout.fillWidth: true
+
+                onTextChanged: {
+                    finder.judgeUrl = text
+                }
+            }
+        } // ColumnLayout
     } // GridLayout
 }
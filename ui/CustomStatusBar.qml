@@ -7,8 +7,8 @@ Page {
     id: root
 
     //! Properties
-    property int progressTotal: 0
-    property int progressPartial: 0
+    property real progressTotal: 0
+    property real progressPartial: 0
     property string messageImageSource;
     property string message;
 
@@ -23,6 +23,14 @@ Page {
         rowLayoutMessage.clearMessage(0)
     }
 
+    // Median and 99th percentile of a stage, in ms
+    function latencyText(stage) {
+        if (!stage || stage.count === 0) {
+            return "-"
+        }
+        return Math.round(stage.p50 / 1000) + '/' + Math.round(stage.p99 / 1000)
+    }
+
     implicitHeight: rowLayoutRoot.implicitHeight + topPadding + bottomPadding
     leftPadding: 10
     rightPadding: 10
@@ -50,9 +58,8 @@ Page {
             Label {
                 id: labelStatus
                 text: finder.gettingAddresses ? qsTr("Initializing") :
-                                                finder.settingCheckers ? qsTr("Addressing") :
-                                                                         finder.scaning ? qsTr("Scaning") :
-                                                                                          !general.proxyConfig.valid ? qsTr("Invalid") : qsTr("Ready")
+                                                finder.scaning ? qsTr("Scaning") :
+                                                                 !general.proxyConfig.valid ? qsTr("Invalid") : qsTr("Ready")
                 horizontalAlignment: Label.AlignLeft | Label.AlignVCenter
                 Layout.fillWidth: true
                 Layout.alignment: Qt.AlignLeft | Qt.AlignVCenter
@@ -79,6 +86,48 @@ Page {
             }
         } // RowLayout
 
+        RowLayout {
+            id: rowLayoutConcurrency
+            visible: finder.running && finder.adaptiveConcurrency
+            Layout.fillHeight: true
+            Layout.alignment: Qt.AlignLeft
+
+            Label {
+                text: qsTr("In flight:")
+                horizontalAlignment: Label.AlignLeft | Label.AlignVCenter
+                Layout.alignment: Qt.AlignLeft | Qt.AlignVCenter
+            }
+            Label {
+                id: labelConcurrency
+                text: finder.concurrency
+                horizontalAlignment: Label.AlignLeft | Label.AlignVCenter
+                Layout.fillWidth: true
+                Layout.alignment: Qt.AlignLeft | Qt.AlignVCenter
+            }
+        } // RowLayout
+
+        RowLayout {
+            id: rowLayoutLatency
+            visible: finder.running
+            Layout.fillHeight: true
+            Layout.alignment: Qt.AlignLeft
+
+            Label {
+                text: qsTr("Latency p50/p99 (ms):")
+                horizontalAlignment: Label.AlignLeft | Label.AlignVCenter
+                Layout.alignment: Qt.AlignLeft | Qt.AlignVCenter
+            }
+            Label {
+                id: labelLatency
+                text: qsTr("connect") + ' ' + latencyText(finder.statistics.connectTime) + ", "
+                      + qsTr("first byte") + ' ' + latencyText(finder.statistics.firstByteTime) + ", "
+                      + qsTr("total") + ' ' + latencyText(finder.statistics.totalTime)
+                horizontalAlignment: Label.AlignLeft | Label.AlignVCenter
+                Layout.fillWidth: true
+                Layout.alignment: Qt.AlignLeft | Qt.AlignVCenter
+            }
+        } // RowLayout
+
         RowLayout {
             id: rowLayoutMessage
             Layout.fillHeight: true
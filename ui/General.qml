@@ -18,22 +18,19 @@ Page {
             break
         case 1: // GettingAddresses
             break
-        case 2: // SettingCheckers
-            progress.Material.accent = Material.Green
-            break
-        case 3: // Scaning
+        case 2: // Scaning
             progress.noAnimate = true
             progress.value = 0
             progress.noAnimate = false
             progress.Material.accent = appWindow.Material.accent
             break
-        case 4: // FinishedAndReady
+        case 3: // FinishedAndReady
             finished()
             progress.noAnimate = true
             progress.value = 0
             progress.noAnimate = false
             break
-        case 5: // AbortedAndReady
+        case 4: // AbortedAndReady
         }
     }
 
@@ -42,11 +39,33 @@ Page {
         statusBarCustom.clearMessage()
         finder.initialAddress = proxyConfig.initialIP
         finder.finalAddress = proxyConfig.finalIP
-        finder.port = ~~proxyConfig.port
+        finder.targets = proxyConfig.targets
+        finder.targetsFile = proxyConfig.targetsFile
+        finder.ports = proxyConfig.ports
         finder.maxThreads = advancedNetworkConfig.maxThreads
+        finder.minThreads = advancedNetworkConfig.minThreads
+        finder.adaptiveConcurrency = advancedNetworkConfig.adaptiveConcurrency
+        finder.rateLimit = advancedNetworkConfig.rateLimit
+        finder.rateBurst = advancedNetworkConfig.rateBurst
+        finder.workerThreads = advancedNetworkConfig.workerThreads
         finder.timeout = advancedNetworkConfig.timeout
+        finder.minTimeout = advancedNetworkConfig.minTimeout
+        finder.adaptiveTimeout = advancedNetworkConfig.adaptiveTimeout
+        finder.connectSweep = advancedNetworkConfig.connectSweep
+        finder.connectTimeout = advancedNetworkConfig.connectTimeout
         finder.requestType = advancedNetworkConfig.requestType
         finder.requestUrl = advancedNetworkConfig.requestUrl
+        finder.engine = advancedNetworkConfig.engine
+        finder.outputFile = advancedNetworkConfig.outputFile
+        finder.outputFormat = advancedNetworkConfig.outputFormat
+        finder.resumeScans = advancedNetworkConfig.resumeScans
+        finder.useHostCache = advancedNetworkConfig.useHostCache
+        finder.liveTtl = advancedNetworkConfig.liveTtl
+        finder.refusedTtl = advancedNetworkConfig.refusedTtl
+        finder.deadTtl = advancedNetworkConfig.deadTtl
+        finder.benchmark = advancedNetworkConfig.benchmark
+        finder.benchmarkSamples = advancedNetworkConfig.benchmarkSamples
+        finder.judgeUrl = advancedNetworkConfig.judgeUrl
         finder.start()
     }
 
@@ -4,6 +4,7 @@ import QtQuick.Controls 2.12
 import QtQuick.Controls.Material 2.12
 import QtQuick.Controls.Material.impl 2.12
 import QtQuick.Layouts 1.12
+import QtQuick.Dialogs 1.3
 
 GroupBox {
     id: root
@@ -11,13 +12,20 @@ GroupBox {
     //! Properties
     property alias initialIP: textFieldInitialIP.text
     property alias finalIP: textFieldFinalIP.text
-    property alias port: textFieldPort.text
+    property alias targets: textFieldTargets.text
+    property alias targetsFile: textFieldTargetsFile.text
+    property alias ports: textFieldPorts.text
 
-    property bool valid: validInitialIP && validFinalIP && validPort
+    // The range may be left empty when a target list is given
+    property bool valid: (validRange || (emptyRange && hasTargets)) && validTargets && validPorts
 
-    property bool validInitialIP: finder.validInitialAddress && (initialIP.split('.').length === 4)
-    property bool validFinalIP: finder.validFinalAddress && (finalIP.split('.').length === 4)
-    property bool validPort: port > 0x0000 && port <= 0xFFFF
+    property bool validInitialIP: (finder.validInitialAddress && (initialIP.split('.').length === 4 || initialIP.indexOf(':') >= 0)) || (emptyRange && hasTargets)
+    property bool validFinalIP: (finder.validFinalAddress && (finalIP.split('.').length === 4 || finalIP.indexOf(':') >= 0)) || (emptyRange && hasTargets)
+    property bool validRange: validInitialIP && validFinalIP
+    property bool emptyRange: initialIP === "" && finalIP === ""
+    property bool hasTargets: targets !== "" || targetsFile !== ""
+    property bool validTargets: finder.validTargets
+    property bool validPorts: finder.validPorts
 
     readonly property color accentColorOk: Material.accent
     readonly property color accentColorError: Material.color(Material.Pink)
@@ -77,113 +85,198 @@ GroupBox {
         }
     } // label: SwitchDelegate
 
-    contentItem: RowLayout {
+    FileDialog {
+        id: fileDialogTargets
+        title: qsTr("Load targets")
+        nameFilters: [ qsTr("Text files (*.txt *.lst)"), qsTr("All files (*)") ]
+        onAccepted: {
+            // Local path, without the drive letter slash on Windows
+            textFieldTargetsFile.text = decodeURIComponent(fileUrl.toString().replace(/^file:\/{2}(\/(?=[A-Za-z]:))?/, ""))
+        }
+    }
+
+    contentItem: ColumnLayout {
         enabled: switchConfigureProxy.checked
-        spacing: 20
-
-        ColumnLayout {
-            Layout.fillWidth: true
-            Label {
-                text: qsTr("Initial IP")
-                property color foregroundColor: validInitialIP ? foregroundColorOk : foregroundColorError
-                Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
-                Material.foreground: foregroundColor
-            }
-            CustomTextField {
-                id: textFieldInitialIP
-                placeholderText: "IP"
-                text: appManager.settings.initialAddress
-                selectByMouse: true
+        spacing: 10
+
+        RowLayout {
+            spacing: 20
+
+            ColumnLayout {
                 Layout.fillWidth: true
+                Label {
+                    text: qsTr("Initial IP")
+                    property color foregroundColor: validInitialIP ? foregroundColorOk : foregroundColorError
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Material.foreground: foregroundColor
+                }
+                CustomTextField {
+                    id: textFieldInitialIP
+                    placeholderText: "IP"
+                    text: appManager.settings.initialAddress
+                    selectByMouse: true
+                    Layout.fillWidth: true
 
-                property color accentColor: validInitialIP ? accentColorOk : accentColorError
-                property color foregroundColor: validInitialIP ? foregroundColorOk : foregroundColorError
+                    property color accentColor: validInitialIP ? accentColorOk : accentColorError
+                    property color foregroundColor: validInitialIP ? foregroundColorOk : foregroundColorError
 
-                Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
-                Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
 
-                Material.accent: accentColor
-                Material.foreground: foregroundColor
+                    Material.accent: accentColor
+                    Material.foreground: foregroundColor
 
-                onTextChanged: {
-                    text = text.trim()
-                    finder.initialAddress = text
-                }
+                    onTextChanged: {
+                        text = text.trim()
+                        finder.initialAddress = text
+                    }
 
-                Component.onCompleted: {
-                    finder.initialAddress = text
+                    Component.onCompleted: {
+                        finder.initialAddress = text
+                    }
                 }
-            }
-        } // ColumnLayout
-        ColumnLayout {
-            Layout.fillWidth: true
-            Label {
-                text: qsTr("Final IP")
-                property color foregroundColor: validFinalIP ? foregroundColorOk : foregroundColorError
-                Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
-                Material.foreground: foregroundColor
-            }
-            CustomTextField {
-                id: textFieldFinalIP
-                placeholderText: "IP"
-                text: appManager.settings.finalAddress
-                selectByMouse: true
+            } // ColumnLayout
+            ColumnLayout {
                 Layout.fillWidth: true
+                Label {
+                    text: qsTr("Final IP")
+                    property color foregroundColor: validFinalIP ? foregroundColorOk : foregroundColorError
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Material.foreground: foregroundColor
+                }
+                CustomTextField {
+                    id: textFieldFinalIP
+                    placeholderText: "IP"
+                    text: appManager.settings.finalAddress
+                    selectByMouse: true
+                    Layout.fillWidth: true
 
-                property color accentColor: validFinalIP ? accentColorOk : accentColorError
-                property color foregroundColor: validFinalIP ? foregroundColorOk : foregroundColorError
+                    property color accentColor: validFinalIP ? accentColorOk : accentColorError
+                    property color foregroundColor: validFinalIP ? foregroundColorOk : foregroundColorError
 
-                Material.accent: accentColor
-                Material.foreground: foregroundColor
+                    Material.accent: accentColor
+                    Material.foreground: foregroundColor
 
-                Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
-                Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
 
-                onTextChanged: {
-                    text = text.trim()
-                    finder.finalAddress = text
-                }
+                    onTextChanged: {
+                        text = text.trim()
+                        finder.finalAddress = text
+                    }
 
-                Component.onCompleted: {
-                    finder.finalAddress = text
+                    Component.onCompleted: {
+                        finder.finalAddress = text
+                    }
+                } // CustomTextField
+            } // ColumnLayout
+            ColumnLayout {
+                Label {
+                    text: qsTr("Ports")
+                    property color foregroundColor: validPorts ? foregroundColorOk : foregroundColorError
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Material.foreground: foregroundColor
                 }
-            } // CustomTextField
-        } // ColumnLayout
-        ColumnLayout {
-            Label {
-                text: qsTr("Port")
-                property color foregroundColor: validPort ? foregroundColorOk : foregroundColorError
-                Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
-                Material.foreground: foregroundColor
-            }
-            CustomTextField {
-                id: textFieldPort
-                placeholderText: "PORT"
-                text: appManager.settings.port
-                selectByMouse: true
-                inputMethodHints: Qt.ImhDigitsOnly
-
-                property color accentColor: validPort ? accentColorOk : accentColorError
-                property color foregroundColor: validPort ? foregroundColorOk : foregroundColorError
-
-                Material.accent: accentColor
-                Material.foreground: foregroundColor
-
-                onTextChanged: {
-                    if (text === "") {
-                        return
-                    } else if (text === "0") {
-                        text = ""
-                        return
+                CustomTextField {
+                    id: textFieldPorts
+                    placeholderText: "80,3128,8000-8100"
+                    text: appManager.settings.ports
+                    selectByMouse: true
+                    Layout.preferredWidth: 150
+
+                    property color accentColor: validPorts ? accentColorOk : accentColorError
+                    property color foregroundColor: validPorts ? foregroundColorOk : foregroundColorError
+
+                    Material.accent: accentColor
+                    Material.foreground: foregroundColor
+
+                    onTextChanged: {
+                        finder.ports = text.trim()
+                    }
+
+                    Component.onCompleted: {
+                        finder.ports = text.trim()
                     }
-                    text = text.trim()
-                    finder.port = text === "" ? 0 : ~~text
+                } // CustomTextField
+            } // ColumnLayoutS
+        } // RowLayout
+
+        RowLayout {
+            spacing: 20
+
+            ColumnLayout {
+                Layout.fillWidth: true
+                Label {
+                    text: qsTr("Targets (CIDR, ranges and IPs)")
+                    property color foregroundColor: validTargets ? foregroundColorOk : foregroundColorError
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Material.foreground: foregroundColor
                 }
+                CustomTextField {
+                    id: textFieldTargets
+                    placeholderText: "10.0.0.0/8, 192.168.1.1-254"
+                    text: appManager.settings.targets
+                    selectByMouse: true
+                    Layout.fillWidth: true
+
+                    property color accentColor: validTargets ? accentColorOk : accentColorError
+                    property color foregroundColor: validTargets ? foregroundColorOk : foregroundColorError
+
+                    Material.accent: accentColor
+                    Material.foreground: foregroundColor
 
-                Component.onCompleted: {
-                    finder.port = text === "" ? 0 : ~~text
+                    Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+
+                    onTextChanged: {
+                        finder.targets = text.trim()
+                    }
+
+                    Component.onCompleted: {
+                        finder.targets = text.trim()
+                    }
+                } // CustomTextField
+            } // ColumnLayout
+            ColumnLayout {
+                Layout.fillWidth: true
+                Label {
+                    text: qsTr("Targets file")
+                    property color foregroundColor: validTargets ? foregroundColorOk : foregroundColorError
+                    Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                    Material.foreground: foregroundColor
                 }
-            } // CustomTextField
-        } // ColumnLayoutS
-    } // contenrItem (RowLayout)
+                RowLayout {
+                    CustomTextField {
+                        id: textFieldTargetsFile
+                        placeholderText: qsTr("One entry per line")
+                        text: appManager.settings.targetsFile
+                        selectByMouse: true
+                        Layout.fillWidth: true
+
+                        property color accentColor: validTargets ? accentColorOk : accentColorError
+                        property color foregroundColor: validTargets ? foregroundColorOk : foregroundColorError
+
+                        Material.accent: accentColor
+                        Material.foreground: foregroundColor
+
+                        Behavior on accentColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+                        Behavior on foregroundColor { ColorAnimation { duration: 250; easing.type: Easing.OutQuart } }
+
+                        onTextChanged: {
+                            finder.targetsFile = text.trim()
+                        }
+
+                        Component.onCompleted: {
+                            finder.targetsFile = text.trim()
+                        }
+                    } // CustomTextField
+                    Button {
+                        text: qsTr("Browse")
+                        flat: true
+                        onClicked: fileDialogTargets.open()
+                    }
+                } // RowLayout
+            } // ColumnLayout
+        } // RowLayout
+    } // contenrItem (ColumnLayout)
 } // GroupBox
@@ -2,12 +2,34 @@ import QtQuick 2.12
 import QtQuick.Controls 2.12
 import QtQuick.Controls.Material 2.12
 import QtQuick.Layouts 1.12
+import ProxyFinder 0.2
 
 Page {
     id: root
 
     property real internalLabelIPWidth: 150
     property real internalLabelCodeWidth: 50
+    property real internalLabelMeasureWidth: 70
+
+    // A second click on the same column reverses the order, a third one goes back to the arrival order
+    function sortBy(role, firstOrder) {
+        var model = finder.reportModel
+        if (model.sortRole !== role) {
+            model.sortOrder = firstOrder
+            model.sortRole = role
+        } else if (model.sortOrder === firstOrder) {
+            model.sortOrder = firstOrder === Qt.AscendingOrder ? Qt.DescendingOrder : Qt.AscendingOrder
+        } else {
+            model.sortRole = 0
+        }
+    }
+
+    function sortIndicator(role) {
+        if (finder.reportModel.sortRole !== role) {
+            return ""
+        }
+        return finder.reportModel.sortOrder === Qt.AscendingOrder ? " \u25B4" : " \u25BE"
+    }
 
     header: ColumnLayout {
 
@@ -15,7 +37,7 @@ Page {
             Layout.topMargin: -20
 
             Label {
-                text: qsTr("Proxy IP")
+                text: qsTr("Proxy")
                 font.pointSize: 9
                 Layout.leftMargin: 16 // spacing property of ItemDelegate (see Qt source code)
                 Layout.preferredWidth: internalLabelIPWidth
@@ -30,6 +52,40 @@ Page {
                 font.pointSize: 9
                 Layout.fillWidth: true
             }
+            Label {
+                text: qsTr("TTFB") + sortIndicator(ReportModel.FirstByteTimeRole)
+                font.pointSize: 9
+                Layout.preferredWidth: internalLabelMeasureWidth
+
+                MouseArea {
+                    anchors.fill: parent
+                    cursorShape: Qt.PointingHandCursor
+                    onClicked: sortBy(ReportModel.FirstByteTimeRole, Qt.AscendingOrder)
+                }
+            }
+            Label {
+                text: qsTr("Speed") + sortIndicator(ReportModel.ThroughputRole)
+                font.pointSize: 9
+                Layout.preferredWidth: internalLabelMeasureWidth
+
+                MouseArea {
+                    anchors.fill: parent
+                    cursorShape: Qt.PointingHandCursor
+                    onClicked: sortBy(ReportModel.ThroughputRole, Qt.DescendingOrder)
+                }
+            }
+            Label {
+                text: qsTr("Anonymity") + sortIndicator(ReportModel.AnonymityRole)
+                font.pointSize: 9
+                Layout.preferredWidth: internalLabelMeasureWidth
+                Layout.rightMargin: 16
+
+                MouseArea {
+                    anchors.fill: parent
+                    cursorShape: Qt.PointingHandCursor
+                    onClicked: sortBy(ReportModel.AnonymityRole, Qt.DescendingOrder)
+                }
+            }
         }
     }
 
@@ -54,28 +110,11 @@ Page {
             ListView {
                 id: list
                 width: parent.width
-                model: 0
+                model: finder.reportModel
 
                 delegate: ReportDelegate {
                     width: root.width
                 }
-
-                Timer {
-                    id: timerReportUpdater
-                    interval: 500
-                    repeat: true
-                    running: finder.scaning
-
-                    onRunningChanged: {
-                        if (!running) {
-                            list.model = finder.reportModel
-                        }
-                    }
-
-                    onTriggered: {
-                        list.model = finder.reportModel
-                    }
-                }
             } // ListView
         } // ScrollView
     } // Rectangle
@@ -9,7 +9,7 @@ ItemDelegate {
     Rectangle {
         id: rectangleHighlight
         anchors.fill: parent
-        color: modelData.httpStatusCode === 0 ? "#5041cd52" : "transparent"
+        color: model.httpStatusCode === 0 ? "#5041cd52" : "transparent"
         z: -1
     }
 
@@ -42,7 +42,7 @@ ItemDelegate {
 
             Label {
                 id: labelCopied
-                text: qsTr("IP copied")
+                text: qsTr("Proxy copied")
                 font.pointSize: Qt.application.font.pointSize * 1.5
                 color: Material.theme === Material.Light ? Material.primaryHighlightedTextColor : Material.background
                 horizontalAlignment: Label.AlignHCenter
@@ -54,21 +54,38 @@ ItemDelegate {
     contentItem: RowLayout {
         Label {
             id: labelIP
-            text: modelData.hostName
+            // IPv6 hosts go between brackets, as in URLs
+            text: (model.hostName.indexOf(':') >= 0 ? '[' + model.hostName + ']' : model.hostName) + ':' + model.port
             Layout.alignment: Qt.AlignVCenter | Qt.AlignLeft
             Layout.preferredWidth: internalLabelIPWidth
         }
         Label {
             id: labelCode
-            text: modelData.httpStatusCode
+            text: model.httpStatusCode
             Layout.alignment: Qt.AlignVCenter | Qt.AlignLeft
             Layout.preferredWidth: internalLabelCodeWidth
         }
         Label {
             id: labelPhrase
-            text: modelData.httpReasonPhrase
+            text: model.httpReasonPhrase
+            elide: Label.ElideRight
             Layout.fillWidth: true
         }
+        Label {
+            id: labelFirstByteTime
+            text: model.benchmarkSamples > 0 ? Math.round(model.firstByteTime / 1000) + " ms" : ""
+            Layout.preferredWidth: internalLabelMeasureWidth
+        }
+        Label {
+            id: labelThroughput
+            text: model.throughput > 0 ? (model.throughput / 1024).toFixed(model.throughput < 10240 ? 1 : 0) + " KiB/s" : ""
+            Layout.preferredWidth: internalLabelMeasureWidth
+        }
+        Label {
+            id: labelAnonymity
+            text: model.anonymity
+            Layout.preferredWidth: internalLabelMeasureWidth
+        }
     } // contentItem (RowLayout)
 
     onClicked: {
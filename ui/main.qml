@@ -17,6 +17,7 @@ ApplicationWindow {
     Material.theme: preferences.theme
 
     //! Properties
+    property bool closeWhenStopped: false
 
     //! Backend
     ApplicationManager {
@@ -29,11 +30,33 @@ ApplicationWindow {
         statusBarCustom.clearMessage()
         finder.initialAddress = general.proxyConfig.initialIP
         finder.finalAddress = general.proxyConfig.finalIP
-        finder.port = ~~general.proxyConfig.port
+        finder.targets = general.proxyConfig.targets
+        finder.targetsFile = general.proxyConfig.targetsFile
+        finder.ports = general.proxyConfig.ports
         finder.maxThreads = advancedNetworkConfig.maxThreads
+        finder.minThreads = advancedNetworkConfig.minThreads
+        finder.adaptiveConcurrency = advancedNetworkConfig.adaptiveConcurrency
+        finder.rateLimit = advancedNetworkConfig.rateLimit
+        finder.rateBurst = advancedNetworkConfig.rateBurst
+        finder.workerThreads = advancedNetworkConfig.workerThreads
         finder.timeout = advancedNetworkConfig.timeout
+        finder.minTimeout = advancedNetworkConfig.minTimeout
+        finder.adaptiveTimeout = advancedNetworkConfig.adaptiveTimeout
+        finder.connectSweep = advancedNetworkConfig.connectSweep
+        finder.connectTimeout = advancedNetworkConfig.connectTimeout
         finder.requestType = advancedNetworkConfig.requestType
         finder.requestUrl = advancedNetworkConfig.requestUrl
+        finder.engine = advancedNetworkConfig.engine
+        finder.outputFile = advancedNetworkConfig.outputFile
+        finder.outputFormat = advancedNetworkConfig.outputFormat
+        finder.resumeScans = advancedNetworkConfig.resumeScans
+        finder.useHostCache = advancedNetworkConfig.useHostCache
+        finder.liveTtl = advancedNetworkConfig.liveTtl
+        finder.refusedTtl = advancedNetworkConfig.refusedTtl
+        finder.deadTtl = advancedNetworkConfig.deadTtl
+        finder.benchmark = advancedNetworkConfig.benchmark
+        finder.benchmarkSamples = advancedNetworkConfig.benchmarkSamples
+        finder.judgeUrl = advancedNetworkConfig.judgeUrl
         finder.start()
     }
 
@@ -147,10 +170,18 @@ ApplicationWindow {
         focus: true
 
         onAccepted: {
-            // FIX: The app crashes
-            finder.clean()
-            finder.terminate()
-            appWindow.close()
+            // The scan is checkpointed while it stops, the window closes right after
+            closeWhenStopped = true
+            finder.stop()
+        }
+    }
+
+    Connections {
+        target: finder
+        onRunningChanged: {
+            if (!finder.running && closeWhenStopped) {
+                appWindow.close()
+            }
         }
     }
 